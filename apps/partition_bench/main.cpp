@@ -0,0 +1,170 @@
+// Compares the spatial partitioners on synthetic scenes: uniform noise plus dense clusters, the
+// uneven density of real levels. For each proxy count it times the initial insert, a few frames that
+// move a tenth of the proxies (with build() after each, like Scene::processCommands), and view
+// volume queries from cameras spread over the scene.
+//
+// Usage: partition_bench [count ...]   (default 10000 100000 1000000)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/math/frustum.h"
+#include "scene/bvh_partition.h"
+#include "scene/grid_partition.h"
+#include "scene/octree_partition.h"
+
+using namespace jaeng;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr int kMoveFrames = 10;
+constexpr int kQueries = 64;
+constexpr float kWorldSize = 2000.0f;
+// Local bounds of every proxy's mesh
+const math::AABB kMeshBounds{ {-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f} };
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<RenderProxy> makeScene(size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> world(-kWorldSize * 0.5f, kWorldSize * 0.5f);
+    std::normal_distribution<float> cluster(0.0f, 15.0f);
+    std::uniform_real_distribution<float> scale(0.5f, 4.0f);
+
+    std::vector<math::vec3> centers(64);
+    for (auto& c : centers) c = { world(rng), world(rng) * 0.05f, world(rng) };
+
+    std::vector<RenderProxy> proxies(count);
+    for (size_t i = 0; i < count; ++i) {
+        math::vec3 p;
+        if (i % 4 == 0) {
+            p = { world(rng), world(rng) * 0.05f, world(rng) };
+        } else {
+            const math::vec3& c = centers[rng() % centers.size()];
+            p = c + math::vec3(cluster(rng), cluster(rng) * 0.2f, cluster(rng));
+        }
+        proxies[i].id = static_cast<uint32_t>(i + 1);
+        proxies[i].worldMatrix = math::scale(math::translate(math::mat4(1.0f), p), math::vec3(scale(rng)));
+        proxies[i].bounds = kMeshBounds.transformed(proxies[i].worldMatrix);
+    }
+    return proxies;
+}
+
+struct Result {
+    double insertMs = 0.0;
+    double moveMs = 0.0;     // Per frame
+    double queryMs = 0.0;    // Per query
+    double visible = 0.0;    // Average proxies per query
+};
+
+Result run(ISpatialPartitioner& partitioner, std::vector<RenderProxy> proxies, const std::vector<math::mat4>& cameras,
+           const std::function<size_t(const math::mat4&)>& query) {
+    Result r;
+    auto start = Clock::now();
+    for (const auto& p : proxies) partitioner.addOrUpdate(p);
+    partitioner.build();
+    r.insertMs = elapsedMs(start);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+    start = Clock::now();
+    for (int frame = 0; frame < kMoveFrames; ++frame) {
+        for (size_t i = frame; i < proxies.size(); i += 10) {
+            math::vec3 delta(step(rng), 0.0f, step(rng));
+            proxies[i].worldMatrix[3] += math::vec4(delta, 0.0f);
+            proxies[i].bounds.min += delta;
+            proxies[i].bounds.max += delta;
+            partitioner.addOrUpdate(proxies[i]);
+        }
+        partitioner.build();
+    }
+    r.moveMs = elapsedMs(start) / kMoveFrames;
+
+    size_t visible = 0;
+    start = Clock::now();
+    for (const auto& viewProj : cameras) visible += query(viewProj);
+    r.queryMs = elapsedMs(start) / cameras.size();
+    r.visible = double(visible) / cameras.size();
+    return r;
+}
+
+void print(const char* name, const Result& r) {
+    std::printf("  %-14s insert %9.2f ms   move 10%% %8.3f ms/frame   query %8.3f ms   visible %10.0f\n",
+                name, r.insertMs, r.moveMs, r.queryMs, r.visible);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> counts;
+    for (int i = 1; i < argc; ++i) counts.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (counts.empty()) counts = { 10000, 100000, 1000000 };
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> world(-kWorldSize * 0.5f, kWorldSize * 0.5f);
+    std::vector<math::mat4> cameras;
+    for (int i = 0; i < kQueries; ++i) {
+        math::vec3 eye(world(rng), 20.0f, world(rng));
+        math::vec3 target = eye + math::vec3(world(rng), 0.0f, world(rng)) * 0.1f;
+        cameras.push_back(math::perspectiveLH_ZO(math::radians(60.0f), 16.0f / 9.0f, 0.1f, 300.0f) *
+                          glm::lookAtLH(eye, target, math::vec3(0.0f, 1.0f, 0.0f)));
+    }
+
+    std::vector<uint32_t> visible;  // Reused by every query, like Scene does
+    for (size_t count : counts) {
+        auto proxies = makeScene(count, rng);
+        std::printf("%zu proxies\n", count);
+
+        {
+            GridPartitioner grid;
+            print("grid (aabb)", run(grid, proxies, cameras, [&](const math::mat4& vp) {
+                grid.queryVisible(math::AABB::fromViewProj(vp), visible);
+                return visible.size();
+            }));
+        }
+        {
+            BvhPartitioner bvh;
+            print("bvh (aabb)", run(bvh, proxies, cameras, [&](const math::mat4& vp) {
+                bvh.queryVisible(math::AABB::fromViewProj(vp), visible);
+                return visible.size();
+            }));
+        }
+        {
+            OctreePartitioner octree;
+            print("octree (aabb)", run(octree, proxies, cameras, [&](const math::mat4& vp) {
+                octree.queryVisible(math::AABB::fromViewProj(vp), visible);
+                return visible.size();
+            }));
+        }
+        {
+            GridPartitioner grid;
+            print("grid (frustum)", run(grid, proxies, cameras, [&](const math::mat4& vp) {
+                grid.queryFrustum(math::Frustum::fromViewProj(vp), visible);
+                return visible.size();
+            }));
+        }
+        {
+            BvhPartitioner bvh;
+            print("bvh (frustum)", run(bvh, proxies, cameras, [&](const math::mat4& vp) {
+                bvh.queryFrustum(math::Frustum::fromViewProj(vp), visible);
+                return visible.size();
+            }));
+        }
+        {
+            OctreePartitioner octree;
+            print("octree (frust)", run(octree, proxies, cameras, [&](const math::mat4& vp) {
+                octree.queryFrustum(math::Frustum::fromViewProj(vp), visible);
+                return visible.size();
+            }));
+        }
+    }
+    return 0;
+}
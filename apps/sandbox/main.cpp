@@ -1,5 +1,6 @@
 #include "platform/public/platform_api.h"
 #include "sandbox_app.h"
+#include <string_view>
 
 #if defined(JAENG_WIN32) && !defined(JAENG_USE_VULKAN)
 #include "pix3.h"
@@ -45,7 +46,13 @@ void android_main(struct android_app* state) {
 }
 #else
 int main(int argc, char* argv[]) {
+#ifdef JAENG_LINUX
+    // --headless runs without a display (servers, CI)
+    bool headless = argc > 1 && std::string_view(argv[1]) == "--headless";
+    auto platform = headless ? create_headless_platform() : create_platform();
+#else
     auto platform = create_platform();
+#endif
     auto app = std::make_unique<SandboxApp>(*platform);
     return platform->run(std::move(app));
 }
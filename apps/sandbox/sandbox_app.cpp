@@ -370,9 +370,10 @@ static const char* materialFileData = "{\n"
   "    \"roughness\": 0.5,\n"
   "    \"metallic\": 0.0\n"
   "  },\n"
+  "  \"maxInstances\": 32,\n"
   "  \"constantBuffers\": [\n"
   "    { \"name\": \"CBFrame\", \"size\": 64, \"binding\": 1 },\n"
-  "    { \"name\": \"CBObject\", \"size\": 96, \"binding\": 2 }\n"
+  "    { \"name\": \"CBObject\", \"size\": 3072, \"binding\": 2 }\n"
   "  ],\n"
   "  \"pipelineStates\": {\n"
   "    \"blend\": { \"enabled\": false, \"srcFactor\": \"one\", \"dstFactor\": \"zero\" },\n"
@@ -530,14 +531,8 @@ void SandboxApp::updateCamera(float dt) {
              float t;
              bool hitAny = false;
              for (auto e : entityManager().getAllEntities<Transform>()) {
-                 if (entityManager().getComponent<CameraComponent>(e)) continue;
-                 
-                 jaeng::math::AABB box { .min = {-0.5f, -0.5f, -0.5f}, .max = {0.5f, 0.5f, 0.5f} };
-                 auto* worldMat = entityManager().getComponent<WorldMatrix>(e);
-                 if (worldMat) {
-                     box.min += jaeng::math::vec3(worldMat->value[3]);
-                     box.max += jaeng::math::vec3(worldMat->value[3]);
-                 }
+                 jaeng::math::AABB box;
+                 if (!getPickBounds(e, box)) continue;
                  if (box.intersects(ray, t)) {
                      hitAny = true;
                      break;
@@ -560,6 +555,18 @@ void SandboxApp::updateCamera(float dt) {
     }
 }
 
+bool SandboxApp::getPickBounds(EntityID e, jaeng::math::AABB& outBounds) {
+    // World bounds of the entity's mesh, the same ones extraction gives its render proxy
+    auto* worldMat = entityManager().getComponent<WorldMatrix>(e);
+    auto* meshComp = entityManager().getComponent<MeshComponent>(e);
+    if (!worldMat || !meshComp) return false;
+
+    auto meshRes = meshSystem().getMesh(meshComp->handle);
+    if (!meshRes.hasValue()) return false;
+    outBounds = std::move(meshRes).logError().value()->bounds.transformed(worldMat->value);
+    return true;
+}
+
 void SandboxApp::handleSelection(bool isLeftDown) {
     if (isLeftDown && !isLooking_) {
         auto ray = getRayFromMouse();
@@ -567,14 +574,8 @@ void SandboxApp::handleSelection(bool isLeftDown) {
         EntityID bestEntity = static_cast<EntityID>(-1);
 
         for (auto e : entityManager().getAllEntities<Transform>()) {
-            if (entityManager().getComponent<CameraComponent>(e)) continue;
-
-            jaeng::math::AABB box { .min = {-0.5f, -0.5f, -0.5f}, .max = {0.5f, 0.5f, 0.5f} };
-            auto* worldMat = entityManager().getComponent<WorldMatrix>(e);
-            if (worldMat) {
-                 box.min += jaeng::math::vec3(worldMat->value[3]);
-                 box.max += jaeng::math::vec3(worldMat->value[3]);
-            }
+            jaeng::math::AABB box;
+            if (!getPickBounds(e, box)) continue;
             float t;
             if (box.intersects(ray, t)) {
                 if (t < minT) {
@@ -608,17 +609,13 @@ math::Ray SandboxApp::getRayFromMouse() const {
     return cam->getRay(x, y);
 }
 
-void SandboxApp::extract_render_state(std::vector<RenderCommand>& outQueue) {
-    outQueue.clear();
+void SandboxApp::extract_render_state(RenderCommandStream& outQueue) {
     if (!isReady_) return;
 
     // 1) Camera State
     if (auto* scene = sceneManager().getScene("Test")) {
         if (auto* cam = static_cast<PerspectiveCamera*>(scene->getCamera())) {
-            RenderCommand cmd;
-            cmd.type = RenderCommandType::UpdateCamera;
-            cmd.cameraViewProj = cam->getViewProj();
-            outQueue.push_back(cmd);
+            outQueue.pushCamera(cam->getViewProj());
         }
     }
 
@@ -632,15 +629,13 @@ void SandboxApp::extract_render_state(std::vector<RenderCommand>& outQueue) {
     }
 
     // 3) UI state every frame to avoid ghosting
-    RenderCommand clearCmd;
-    clearCmd.type = RenderCommandType::ClearUI;
-    outQueue.push_back(clearCmd);
+    outQueue.pushClearUI();
 
     // 4) UI State (Engine-managed extraction)
     UIRenderSystem::extract(entityManager(), fontSystem(), outQueue);
 }
 
-void SandboxApp::render(const std::vector<RenderCommand>& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) {
+void SandboxApp::render(const RenderCommandStream& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) {
     if (stateMachine_) stateMachine_->render(inQueue, hasNewState, graph, backbuffer, depthbuffer);
 
     Scene* scene = sceneManager().getScene("Test");
@@ -651,14 +646,14 @@ void SandboxApp::render(const std::vector<RenderCommand>& inQueue, bool hasNewSt
         scene->processCommands(inQueue);
     } else {
         // Even if no state change, we still need to sync the camera every frame
-        for (const auto& cmd : inQueue) {
-            if (cmd.type == RenderCommandType::UpdateCamera) {
-                scene->setCameraViewProj(cmd.cameraViewProj);
+        for (auto cmd : inQueue) {
+            if (cmd.type() == RenderCommandType::UpdateCamera) {
+                scene->setCameraViewProj(cmd.cameraViewProj());
             }
         }
     }
     
-    scene->buildDrawList({});
+    scene->buildDrawList();
     float scaleX = 1.0f;
     float scaleY = 1.0f;
     if (window().get_width() > 0 && window().get_height() > 0) {
@@ -24,8 +24,8 @@ public:
 
 protected:
     void tick(float dt) override;
-    void extract_render_state(std::vector<jaeng::RenderCommand>& outQueue) override;
-    void render(const std::vector<jaeng::RenderCommand>& inQueue, bool hasNewState, jaeng::RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) override;
+    void extract_render_state(jaeng::RenderCommandStream& outQueue) override;
+    void render(const jaeng::RenderCommandStream& inQueue, bool hasNewState, jaeng::RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) override;
 
 private:
     void setupAnimation();
@@ -62,6 +62,7 @@ private:
 
     void updateCamera(float dt);
     void handleSelection(bool isLeftDown);
+    bool getPickBounds(jaeng::EntityID e, jaeng::math::AABB& outBounds);
     jaeng::math::Ray getRayFromMouse() const;
 
     // Test resources
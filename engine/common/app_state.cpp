@@ -9,11 +9,17 @@ AppStateMachine::AppStateMachine(platform::IApplication& app)
 AppStateMachine::~AppStateMachine() {
     // Exit all states
     while (!states_.empty()) {
-        states_.back()->onExit(app_);
-        states_.pop_back();
+        exitTopState();
     }
 }
 
+void AppStateMachine::exitTopState() {
+    auto& state = states_.back();
+    state->lifetime_.cancel();
+    state->onExit(app_);
+    states_.pop_back();
+}
+
 void AppStateMachine::changeState(std::unique_ptr<IAppState> newState) {
     pendingTransition_ = TransitionType::Change;
     pendingState_ = std::move(newState);
@@ -35,8 +41,7 @@ void AppStateMachine::processPendingTransitions() {
 
     if (pendingTransition_ == TransitionType::Change) {
         if (!states_.empty()) {
-            states_.back()->onExit(app_);
-            states_.pop_back();
+            exitTopState();
         }
         if (pendingState_) {
             pendingState_->onEnter(app_);
@@ -49,8 +54,7 @@ void AppStateMachine::processPendingTransitions() {
         }
     } else if (pendingTransition_ == TransitionType::Pop) {
         if (!states_.empty()) {
-            states_.back()->onExit(app_);
-            states_.pop_back();
+            exitTopState();
         }
     }
 
@@ -66,13 +70,13 @@ void AppStateMachine::tick(float dt) {
     }
 }
 
-void AppStateMachine::extract(std::vector<RenderCommand>& outQueue) {
+void AppStateMachine::extract(RenderCommandStream& outQueue) {
     if (!states_.empty()) {
         states_.back()->extract(app_, outQueue);
     }
 }
 
-void AppStateMachine::render(const std::vector<RenderCommand>& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) {
+void AppStateMachine::render(const RenderCommandStream& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) {
     if (!states_.empty()) {
         states_.back()->render(app_, inQueue, hasNewState, graph, backbuffer, depthbuffer);
     }
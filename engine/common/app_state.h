@@ -19,8 +19,16 @@ public:
     // Lifecycle events delegated from IApplication
     virtual void onEvent(platform::IApplication& app, const platform::Event& ev) {}
     virtual void tick(platform::IApplication& app, float dt) {}
-    virtual void extract(platform::IApplication& app, std::vector<RenderCommand>& outQueue) {}
-    virtual void render(platform::IApplication& app, const std::vector<RenderCommand>& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) {}
+    virtual void extract(platform::IApplication& app, RenderCommandStream& outQueue) {}
+    virtual void render(platform::IApplication& app, const RenderCommandStream& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) {}
+
+    // Pass this to async loads started by the state; it is cancelled right before onExit so
+    // in-flight work stops instead of finishing for nobody
+    async::CancellationToken lifetimeToken() const { return lifetime_.token(); }
+
+private:
+    friend class AppStateMachine;
+    async::CancellationSource lifetime_;
 };
 
 class AppStateMachine {
@@ -35,12 +43,13 @@ public:
 
     // Immediate Lifecycle delegation
     void tick(float dt);
-    void extract(std::vector<RenderCommand>& outQueue);
-    void render(const std::vector<RenderCommand>& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer);
+    void extract(RenderCommandStream& outQueue);
+    void render(const RenderCommandStream& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer);
     void onEvent(const platform::Event& ev);
 
 private:
     void processPendingTransitions();
+    void exitTopState();
 
     platform::IApplication& app_;
     std::vector<std::unique_ptr<IAppState>> states_;
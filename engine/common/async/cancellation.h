@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include "common/result.h"
+
+namespace jaeng::async {
+
+// Cooperative cancellation. A source owns the flag, tokens are cheap copies that can be
+// handed to queued work and coroutines. A default-constructed token is never cancelled.
+// Tokens are passed explicitly (enqueue_async/enqueue_io, loadAsync, the *Async asset calls)
+// rather than stored in Task/Future, so a coroutine checks the token it was given at its awaits.
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    bool is_cancelled() const noexcept { return state_ && state_->cancelled.load(std::memory_order_acquire); }
+    bool can_be_cancelled() const noexcept { return state_ != nullptr; }
+
+private:
+    friend class CancellationSource;
+
+    struct State {
+        std::atomic<bool> cancelled = false;
+    };
+
+    explicit CancellationToken(std::shared_ptr<const State> state) : state_(std::move(state)) {}
+
+    std::shared_ptr<const State> state_;
+};
+
+class CancellationSource {
+public:
+    CancellationSource() : state_(std::make_shared<CancellationToken::State>()) {}
+
+    CancellationToken token() const { return CancellationToken(state_); }
+    void cancel() noexcept { state_->cancelled.store(true, std::memory_order_release); }
+    bool is_cancelled() const noexcept { return state_->cancelled.load(std::memory_order_acquire); }
+
+    // Starts a fresh generation; tokens handed out before keep their (cancelled) state
+    void reset() { state_ = std::make_shared<CancellationToken::State>(); }
+
+private:
+    std::shared_ptr<CancellationToken::State> state_;
+};
+
+template<typename T>
+struct is_result : std::false_type {};
+
+template<typename T>
+struct is_result<result<T>> : std::true_type {};
+
+inline Error cancelled_error() {
+    return Error::fromMessage(static_cast<int>(error_code::cancelled), "Operation cancelled");
+}
+
+// Work that can be dropped before it runs: the caller must be able to tell that apart from a real
+// result, so only result<T> (completing with cancelled_error()) and void qualify
+template<typename T>
+inline constexpr bool is_cancellable_v = std::is_void_v<T> || is_result<T>::value;
+
+} // namespace jaeng::async
+
+// Stops a coroutine returning result<T> at an await point once its token is cancelled
+#define JAENG_RETURN_IF_CANCELLED_ASYNC(token) \
+    if ((token).is_cancelled()) co_return jaeng::async::cancelled_error()
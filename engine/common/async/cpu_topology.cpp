@@ -0,0 +1,300 @@
+#include "cpu_topology.h"
+#include "common/logging.h"
+
+#include <algorithm>
+#include <format>
+#include <map>
+#include <thread>
+
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace jaeng::async {
+
+namespace {
+
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+constexpr bool kAffinitySupported = true;
+#else
+constexpr bool kAffinitySupported = false;
+#endif
+
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+constexpr const char* kSysCpuPath = "/sys/devices/system/cpu";
+
+bool read_line(const std::string& path, std::string& out) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::getline(file, out);
+    return !out.empty();
+}
+
+bool read_u32(const std::string& path, uint32_t& out) {
+    std::string line;
+    if (!read_line(path, line)) return false;
+    try {
+        out = static_cast<uint32_t>(std::stoul(line));
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+// Parses the kernel cpu list format, e.g. "0-3,8,10-11"
+std::vector<uint32_t> parse_cpu_list(const std::string& list) {
+    std::vector<uint32_t> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        std::string range = list.substr(pos, comma - pos);
+        pos = comma + 1;
+        if (range.empty()) continue;
+
+        try {
+            size_t dash = range.find('-');
+            uint32_t first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+            uint32_t last = dash == std::string::npos ? first : static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+            for (uint32_t c = first; c <= last; ++c) cpus.push_back(c);
+        } catch (...) {
+            // Ignore malformed ranges, the rest of the list is still usable
+        }
+    }
+    return cpus;
+}
+
+std::vector<uint32_t> read_cpu_list(const std::string& path) {
+    std::string line;
+    if (!read_line(path, line)) return {};
+    return parse_cpu_list(line);
+}
+
+// Logical CPUs this process may run on (cgroups/taskset can restrict this below "online")
+std::vector<uint32_t> allowed_cpus() {
+    std::vector<uint32_t> online = read_cpu_list(std::string(kSysCpuPath) + "/online");
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return online;
+
+    std::vector<uint32_t> allowed;
+    if (online.empty()) {
+        for (uint32_t c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &set)) allowed.push_back(c);
+        }
+    } else {
+        for (uint32_t c : online) {
+            if (c < CPU_SETSIZE && CPU_ISSET(c, &set)) allowed.push_back(c);
+        }
+    }
+    return allowed;
+}
+
+void classify_hybrid(std::vector<LogicalCpu>& cpus) {
+    // Intel hybrid parts expose one PMU per core type
+    std::vector<uint32_t> pCores = read_cpu_list("/sys/devices/cpu_core/cpus");
+    std::vector<uint32_t> eCores = read_cpu_list("/sys/devices/cpu_atom/cpus");
+    if (!pCores.empty() && !eCores.empty()) {
+        for (auto& cpu : cpus) {
+            if (std::ranges::find(pCores, cpu.id) != pCores.end()) cpu.kind = CoreKind::Performance;
+            else if (std::ranges::find(eCores, cpu.id) != eCores.end()) cpu.kind = CoreKind::Efficiency;
+        }
+        return;
+    }
+
+    // ARM big.LITTLE (and anything else reporting capacity): split on relative capacity
+    uint32_t maxCapacity = 0;
+    uint32_t minCapacity = UINT32_MAX;
+    for (const auto& cpu : cpus) {
+        if (cpu.capacity == 0) return;
+        maxCapacity = std::max(maxCapacity, cpu.capacity);
+        minCapacity = std::min(minCapacity, cpu.capacity);
+    }
+    if (cpus.empty() || minCapacity == maxCapacity) {
+        for (auto& cpu : cpus) cpu.kind = CoreKind::Performance;
+        return;
+    }
+    for (auto& cpu : cpus) {
+        // Prime and big clusters both count as performance cores
+        cpu.kind = cpu.capacity * 5 >= maxCapacity * 4 ? CoreKind::Performance : CoreKind::Efficiency;
+    }
+}
+#endif
+
+} // namespace
+
+CpuTopology CpuTopology::detect() {
+    CpuTopology topo;
+
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+    // Logical CPUs sharing a core report the same sibling list; use it as the core key since
+    // core_id alone is not unique across clusters on some ARM kernels.
+    std::map<std::string, size_t> coreIndex;
+    for (uint32_t id : allowed_cpus()) {
+        std::string base = std::format("{}/cpu{}/", kSysCpuPath, id);
+
+        LogicalCpu cpu;
+        cpu.id = id;
+        read_u32(base + "topology/core_id", cpu.coreId);
+        read_u32(base + "topology/physical_package_id", cpu.packageId);
+        if (!read_u32(base + "cpu_capacity", cpu.capacity)) {
+            read_u32(base + "cpufreq/cpuinfo_max_freq", cpu.capacity);
+        }
+
+        std::string siblings;
+        if (!read_line(base + "topology/thread_siblings_list", siblings)) {
+            siblings = std::to_string(id);
+        }
+
+        auto [it, inserted] = coreIndex.try_emplace(siblings, topo.cores.size());
+        if (inserted) {
+            topo.cores.push_back({cpu.packageId, cpu.coreId, 0, CoreKind::Unknown, {}});
+        }
+        topo.cores[it->second].cpus.push_back(id);
+        topo.cpus.push_back(cpu);
+    }
+
+    classify_hybrid(topo.cpus);
+#endif
+
+    if (topo.cpus.empty()) {
+        uint32_t count = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t i = 0; i < count; ++i) {
+            topo.cpus.push_back({i, i, 0, 0, 0, CoreKind::Unknown});
+            topo.cores.push_back({0, i, 0, CoreKind::Unknown, {i}});
+        }
+        return topo;
+    }
+
+    // Fold per-CPU data into the physical cores and assign SMT indices
+    auto findCpu = [&](uint32_t id) -> LogicalCpu& {
+        return *std::ranges::find(topo.cpus, id, &LogicalCpu::id);
+    };
+    bool hasP = false;
+    bool hasE = false;
+    for (auto& core : topo.cores) {
+        std::ranges::sort(core.cpus);
+        for (uint32_t i = 0; i < core.cpus.size(); ++i) {
+            LogicalCpu& cpu = findCpu(core.cpus[i]);
+            cpu.smtIndex = i;
+            core.capacity = std::max(core.capacity, cpu.capacity);
+            if (core.kind == CoreKind::Unknown) core.kind = cpu.kind;
+        }
+        hasP |= core.kind == CoreKind::Performance;
+        hasE |= core.kind == CoreKind::Efficiency;
+    }
+    topo.hybrid = hasP && hasE;
+
+    // Performance cores first, then efficiency, then unclassified ones; the fastest first within each
+    auto rank = [](CoreKind kind) {
+        switch (kind) {
+            case CoreKind::Performance: return 0;
+            case CoreKind::Efficiency:  return 1;
+            default:                    return 2;
+        }
+    };
+    std::ranges::stable_sort(topo.cores, [&rank](const PhysicalCore& a, const PhysicalCore& b) {
+        if (rank(a.kind) != rank(b.kind)) return rank(a.kind) < rank(b.kind);
+        return a.capacity > b.capacity;
+    });
+    return topo;
+}
+
+std::string CpuTopology::describe() const {
+    std::string out = std::format("{} logical / {} physical CPUs", logical_count(), physical_count());
+    if (hybrid) {
+        auto pCount = std::ranges::count(cores, CoreKind::Performance, &PhysicalCore::kind);
+        out += std::format(" (hybrid: {}P + {}E)", pCount, cores.size() - pCount);
+    }
+    return out;
+}
+
+AffinityPlan plan_affinity(const CpuTopology& topology, const AffinityConfig& config) {
+    AffinityPlan plan;
+    plan.ioWorkerCount = std::max(1u, config.ioWorkerCount);
+    plan.pinned = config.pinThreads && kAffinitySupported;
+    if (config.pinThreads && !kAffinitySupported) {
+        JAENG_LOG_INFO("[Affinity] Thread pinning is not supported on this platform, threads will float");
+    }
+
+    // Reserve the fastest cores for sim and render, but always leave at least one core for workers
+    uint32_t wanted = (config.reserveSimulationCore ? 1u : 0u) + (config.reserveRenderCore ? 1u : 0u);
+    uint32_t reserved = topology.physical_count() > wanted ? wanted : 0;
+    if (reserved < wanted) {
+        JAENG_LOG_WARN("[Affinity] Only {} physical cores available, not reserving cores for sim/render",
+                       topology.physical_count());
+    }
+
+    uint32_t next = 0;
+    if (reserved > 0 && config.reserveSimulationCore) plan.simulation = topology.cores[next++].cpus;
+    if (reserved > 0 && config.reserveRenderCore) plan.render = topology.cores[next++].cpus;
+
+    // Worker slots: primary hardware thread of every unreserved core first, then their SMT siblings
+    std::vector<uint32_t> slots;
+    std::vector<uint32_t> unreserved;
+    size_t maxSmt = 1;
+    for (size_t c = next; c < topology.cores.size(); ++c) maxSmt = std::max(maxSmt, topology.cores[c].cpus.size());
+    for (size_t level = 0; level < maxSmt; ++level) {
+        for (size_t c = next; c < topology.cores.size(); ++c) {
+            const auto& cpus = topology.cores[c].cpus;
+            if (level < cpus.size()) {
+                slots.push_back(cpus[level]);
+                unreserved.push_back(cpus[level]);
+            }
+        }
+    }
+
+    uint32_t workerCount = config.workerCount;
+    if (workerCount == 0) {
+        workerCount = config.smtPolicy == SmtPolicy::AvoidSiblings ? topology.physical_count() - next
+                                                                   : static_cast<uint32_t>(slots.size());
+        workerCount = std::max(1u, workerCount);
+    }
+
+    plan.workers.resize(workerCount);
+    if (plan.pinned && !slots.empty()) {
+        for (uint32_t i = 0; i < workerCount; ++i) {
+            plan.workers[i] = {slots[i % slots.size()]};
+        }
+
+        // IO threads spend most of their time blocked; park them on E-cores when there are some,
+        // otherwise keep them off the reserved cores
+        if (topology.hybrid && config.ioOnEfficiencyCores) {
+            for (const auto& core : topology.cores) {
+                if (core.kind == CoreKind::Efficiency) plan.io.insert(plan.io.end(), core.cpus.begin(), core.cpus.end());
+            }
+        }
+        if (plan.io.empty()) plan.io = unreserved;
+        std::ranges::sort(plan.io);
+    } else {
+        plan.simulation.clear();
+        plan.render.clear();
+    }
+
+    return plan;
+}
+
+bool set_current_thread_affinity(std::span<const uint32_t> cpus) {
+    if (cpus.empty()) return true;
+
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t cpu : cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+#if defined(JAENG_ANDROID)
+    // Bionic has no pthread_setaffinity_np; sched_setaffinity(0) targets the calling thread
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+#else
+    return false;
+#endif
+}
+
+} // namespace jaeng::async
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace jaeng::async {
+
+enum class CoreKind : uint8_t {
+    Unknown = 0,
+    Performance,
+    Efficiency,
+};
+
+// A single logical CPU (hardware thread) as reported by the OS
+struct LogicalCpu {
+    uint32_t id = 0;          // OS cpu index, used for affinity masks
+    uint32_t coreId = 0;      // Physical core id within the package
+    uint32_t packageId = 0;   // Socket
+    uint32_t capacity = 0;    // Relative performance (cpu_capacity or max frequency), 0 if unknown
+    uint32_t smtIndex = 0;    // 0 for the first hardware thread of a core, 1+ for its SMT siblings
+    CoreKind kind = CoreKind::Unknown;
+};
+
+// A physical core and the logical CPUs (SMT siblings) that share it
+struct PhysicalCore {
+    uint32_t packageId = 0;
+    uint32_t coreId = 0;
+    uint32_t capacity = 0;
+    CoreKind kind = CoreKind::Unknown;
+    std::vector<uint32_t> cpus; // Logical CPU ids, primary hardware thread first
+};
+
+struct CpuTopology {
+    std::vector<LogicalCpu> cpus;
+    std::vector<PhysicalCore> cores; // Sorted fastest first (P-cores before E-cores)
+    bool hybrid = false;             // True when both performance and efficiency cores are present
+
+    // Reads the topology of the CPUs this process is allowed to run on.
+    // On Linux this comes from /sys/devices/system/cpu, elsewhere it falls back to
+    // hardware_concurrency() with one logical CPU per core.
+    static CpuTopology detect();
+
+    uint32_t logical_count() const { return static_cast<uint32_t>(cpus.size()); }
+    uint32_t physical_count() const { return static_cast<uint32_t>(cores.size()); }
+    std::string describe() const;
+};
+
+enum class SmtPolicy : uint8_t {
+    // Place one worker per physical core before using SMT siblings. Reserved cores keep
+    // their siblings idle so sim/render never share execution units with a worker.
+    AvoidSiblings,
+    // Treat every logical CPU as a separate slot
+    UseAllThreads,
+};
+
+struct AffinityConfig {
+    bool pinThreads = false;            // Apply affinity masks; when false only the worker count is derived
+    bool reserveSimulationCore = true;  // Keep a physical core out of the worker pool for the sim thread
+    bool reserveRenderCore = true;      // Keep a physical core out of the worker pool for the render thread
+    bool ioOnEfficiencyCores = true;    // On hybrid CPUs, run IO workers on E-cores
+    SmtPolicy smtPolicy = SmtPolicy::AvoidSiblings;
+    uint32_t workerCount = 0;           // 0 = derive from the unreserved cores
+    uint32_t ioWorkerCount = 1;
+};
+
+// The resolved placement of every engine thread. An empty cpu list means "don't pin".
+struct AffinityPlan {
+    std::vector<uint32_t> simulation;
+    std::vector<uint32_t> render;
+    std::vector<std::vector<uint32_t>> workers; // One entry per compute worker
+    std::vector<uint32_t> io;                   // Shared mask for all IO workers
+    uint32_t ioWorkerCount = 1;
+    bool pinned = false;
+
+    uint32_t worker_count() const { return static_cast<uint32_t>(workers.size()); }
+};
+
+AffinityPlan plan_affinity(const CpuTopology& topology, const AffinityConfig& config);
+
+// Restricts the calling thread to the given logical CPUs. Returns false when the platform
+// doesn't support it or the call failed; an empty span is a no-op that returns true.
+bool set_current_thread_affinity(std::span<const uint32_t> cpus);
+
+} // namespace jaeng::async
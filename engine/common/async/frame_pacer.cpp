@@ -0,0 +1,124 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <format>
+#include <thread>
+
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+#include <time.h>
+#elif defined(JAENG_WIN32)
+#include <windows.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace jaeng::async {
+
+namespace {
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+inline uint64_t to_ns(FramePacer::Clock::duration d) {
+    return static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+}
+
+} // namespace
+
+FramePacer::FramePacer(std::chrono::microseconds spinThreshold)
+    : spinThreshold_(spinThreshold)
+{
+#if defined(JAENG_WIN32)
+    // Plain Sleep() rounds up to the scheduler quantum (~15ms); the high resolution timer does not
+    timer_ = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+}
+
+FramePacer::~FramePacer() {
+#if defined(JAENG_WIN32)
+    if (timer_) CloseHandle(timer_);
+#endif
+}
+
+void FramePacer::sleep_until(Clock::time_point wakeAt) {
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+    // steady_clock is CLOCK_MONOTONIC here, so the deadline can be passed through as is
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wakeAt.time_since_epoch()).count();
+    timespec ts{ static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#elif defined(JAENG_WIN32)
+    auto remaining = wakeAt - Clock::now();
+    if (timer_ && remaining > Clock::duration::zero()) {
+        LARGE_INTEGER due;
+        due.QuadPart = -static_cast<LONGLONG>(to_ns(remaining) / 100); // Relative, in 100ns units
+        if (SetWaitableTimer(timer_, &due, 0, nullptr, nullptr, FALSE)) {
+            WaitForSingleObject(timer_, INFINITE);
+            return;
+        }
+    }
+    std::this_thread::sleep_until(wakeAt);
+#else
+    std::this_thread::sleep_until(wakeAt);
+#endif
+}
+
+void FramePacer::wait_until(Clock::time_point deadline) {
+    waits_.fetch_add(1, std::memory_order_relaxed);
+
+    auto start = Clock::now();
+    if (start >= deadline) {
+        missed_.fetch_add(1, std::memory_order_relaxed);
+        lateness_.record(start - deadline);
+        return;
+    }
+
+    auto spinFrom = deadline - spinThreshold_;
+    if (start < spinFrom) {
+        sleep_until(spinFrom);
+    }
+
+    auto spinStart = Clock::now();
+    auto now = spinStart;
+    while (now < deadline) {
+        cpu_relax();
+        now = Clock::now();
+    }
+
+    sleptNs_.fetch_add(to_ns(spinStart - start), std::memory_order_relaxed);
+    spunNs_.fetch_add(to_ns(now - spinStart), std::memory_order_relaxed);
+    lateness_.record(now - deadline);
+}
+
+FramePacer::Stats FramePacer::stats() const {
+    Stats s;
+    s.wakeLateness = lateness_.snapshot();
+    s.waits = waits_.load(std::memory_order_relaxed);
+    s.missedDeadlines = missed_.load(std::memory_order_relaxed);
+    s.sleptMs = static_cast<double>(sleptNs_.load(std::memory_order_relaxed)) / 1e6;
+    s.spunMs = static_cast<double>(spunNs_.load(std::memory_order_relaxed)) / 1e6;
+    return s;
+}
+
+void FramePacer::reset_stats() {
+    lateness_.reset();
+    waits_.store(0, std::memory_order_relaxed);
+    missed_.store(0, std::memory_order_relaxed);
+    sleptNs_.store(0, std::memory_order_relaxed);
+    spunNs_.store(0, std::memory_order_relaxed);
+}
+
+std::string FramePacer::Stats::format() const {
+    return std::format("waits={} missed={} late mean={:.1f}us p99<={:.0f}us max={:.1f}us slept={:.1f}ms spun={:.1f}ms",
+                       waits, missedDeadlines, wakeLateness.meanUs, wakeLateness.percentileUs(0.99), wakeLateness.maxUs,
+                       sleptMs, spunMs);
+}
+
+} // namespace jaeng::async
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "scheduler_stats.h"
+
+namespace jaeng::async {
+
+// Sleeps a thread until an absolute deadline without drifting and without burning a core.
+// The bulk of the wait is an OS sleep on the monotonic clock (clock_nanosleep with TIMER_ABSTIME on
+// Linux/Android, a high resolution waitable timer on Windows); the last spinThreshold before the
+// deadline is spun, since OS wakeups routinely land tens to hundreds of microseconds late.
+// Every wait records how late it actually woke up, which is the tick jitter seen by the caller.
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer(std::chrono::microseconds spinThreshold = std::chrono::microseconds(500));
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // Returns once Clock::now() >= deadline. A deadline already in the past counts as a missed one.
+    void wait_until(Clock::time_point deadline);
+
+    void set_spin_threshold(std::chrono::microseconds spinThreshold) { spinThreshold_ = spinThreshold; }
+
+    struct Stats {
+        LatencyHistogram::Snapshot wakeLateness;  // Actual wake time minus deadline
+        uint64_t waits = 0;
+        uint64_t missedDeadlines = 0;              // Deadline had already passed when wait_until was called
+        double sleptMs = 0.0;
+        double spunMs = 0.0;
+
+        std::string format() const;
+    };
+    Stats stats() const;
+    void reset_stats();
+
+private:
+    void sleep_until(Clock::time_point wakeAt);
+
+    std::chrono::microseconds spinThreshold_;
+    LatencyHistogram lateness_;
+    std::atomic<uint64_t> waits_ = 0;
+    std::atomic<uint64_t> missed_ = 0;
+    std::atomic<uint64_t> sleptNs_ = 0;
+    std::atomic<uint64_t> spunNs_ = 0;
+#if defined(JAENG_WIN32)
+    void* timer_ = nullptr;
+#endif
+};
+
+} // namespace jaeng::async
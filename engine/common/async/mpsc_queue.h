@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+namespace jaeng::async {
+
+struct MpscNode {
+    std::atomic<MpscNode*> next = nullptr;
+};
+
+// Intrusive lock-free multi-producer single-consumer queue (Vyukov).
+// push() is wait-free and may be called from any thread; pop() must only be called by the consumer.
+// pop() can return nullptr while a producer is between its two stores even though the queue is not
+// empty, so callers that need an exact answer track the element count separately.
+template<typename T>
+class MpscQueue {
+    static_assert(std::is_base_of_v<MpscNode, T>, "MpscQueue elements must derive from MpscNode");
+
+public:
+    MpscQueue() = default;
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T* node) noexcept { push_node(node); }
+
+    T* pop() noexcept {
+        MpscNode* tail = tail_;
+        MpscNode* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (!next) return nullptr;
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        if (tail != head_.load(std::memory_order_acquire)) return nullptr; // Producer mid-push
+
+        // Last element: put the stub back behind it so tail can advance
+        push_node(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        return nullptr;
+    }
+
+private:
+    void push_node(MpscNode* node) noexcept {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    MpscNode stub_;
+    std::atomic<MpscNode*> head_ = &stub_; // Producers
+    MpscNode* tail_ = &stub_;              // Consumer
+};
+
+} // namespace jaeng::async
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include "awaiters.h"
+
+namespace jaeng::async {
+
+// Splits [0, count) into ranges of chunkSize and calls fn(chunkIndex, begin, end) for each, spreading
+// the chunks over the current scheduler's workers. Chunks are claimed from a shared counter by the
+// caller and by helper tasks queued on the workers; the caller only waits for helpers that actually
+// claimed a chunk, so when the workers are busy with other queued work it simply runs every chunk
+// itself instead of waiting behind that backlog. Returns once every chunk is done, so fn may write to
+// per-chunk outputs that are merged afterwards in chunk order.
+// Runs everything inline when there is no running scheduler or when called from a worker (to avoid
+// waiting on the pool from inside it). Returns the number of chunks.
+template<typename F>
+size_t parallel_for_chunks(size_t count, size_t chunkSize, F&& fn) {
+    if (count == 0) return 0;
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    auto* scheduler = get_current_scheduler();
+    if (chunkCount == 1 || !scheduler || scheduler->worker_count() == 0 || scheduler->is_worker_thread()) {
+        for (size_t c = 0; c < chunkCount; ++c) {
+            fn(c, c * chunkSize, std::min(count, (c + 1) * chunkSize));
+        }
+        return chunkCount;
+    }
+
+    // Outlives the call: helpers picked up after every chunk was claimed still read it. A helper
+    // registers in active before claiming, and only touches fn once it owns a chunk.
+    struct Shared {
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> active = 0;
+    };
+    auto shared = std::make_shared<Shared>();
+    auto runChunks = [&fn, chunkCount, chunkSize, count](Shared& state) {
+        for (size_t c = state.next.fetch_add(1); c < chunkCount; c = state.next.fetch_add(1)) {
+            fn(c, c * chunkSize, std::min(count, (c + 1) * chunkSize));
+        }
+    };
+
+    const size_t helpers = std::min(chunkCount - 1, scheduler->worker_count());
+    for (size_t h = 0; h < helpers; ++h) {
+        try {
+            scheduler->enqueue_async([shared, runChunks]() {
+                shared->active.fetch_add(1);
+                runChunks(*shared);
+                if (shared->active.fetch_sub(1) == 1) shared->active.notify_all();
+            });
+        } catch (const std::runtime_error&) {
+            // Scheduler is shutting down, the caller claims the rest
+            break;
+        }
+    }
+    runChunks(*shared);
+
+    // Every chunk is claimed, wait for the helpers still running theirs
+    for (size_t active = shared->active.load(); active != 0; active = shared->active.load()) {
+        shared->active.wait(active);
+    }
+    return chunkCount;
+}
+
+} // namespace jaeng::async
@@ -0,0 +1,79 @@
+#include "scheduler_stats.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+
+namespace jaeng::async {
+
+void LatencyHistogram::record(SchedulerClock::duration latency) noexcept {
+    uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()));
+    uint64_t us = ns / 1000;
+    size_t bucket = std::min<size_t>(std::bit_width(us), kBucketCount - 1);
+
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    totalNs_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t prevMax = maxNs_.load(std::memory_order_relaxed);
+    while (ns > prevMax && !maxNs_.compare_exchange_weak(prevMax, ns, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() noexcept {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    totalNs_.store(0, std::memory_order_relaxed);
+    maxNs_.store(0, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const noexcept {
+    Snapshot s;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        s.count += s.buckets[i];
+    }
+    if (s.count > 0) {
+        s.meanUs = static_cast<double>(totalNs_.load(std::memory_order_relaxed)) / 1000.0 / static_cast<double>(s.count);
+    }
+    s.maxUs = static_cast<double>(maxNs_.load(std::memory_order_relaxed)) / 1000.0;
+    return s;
+}
+
+double LatencyHistogram::bucketUpperBoundUs(size_t bucket) {
+    return static_cast<double>(uint64_t(1) << bucket);
+}
+
+double LatencyHistogram::Snapshot::percentileUs(double p) const {
+    if (count == 0) return 0.0;
+    uint64_t target = static_cast<uint64_t>(p * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i];
+        if (seen > target) return std::min(bucketUpperBoundUs(i), maxUs);
+    }
+    return maxUs;
+}
+
+namespace {
+
+void format_queue(std::string& out, const char* name, const QueueStats& q) {
+    out += std::format("  {:<5} enq={:<8} exec={:<8} depth={:<5} peak={:<5} latency(us) mean={:.1f} p50<={:.0f} p95<={:.0f} p99<={:.0f} max={:.1f}\n",
+                       name, q.enqueued, q.executed, q.depth, q.peakDepth, q.latency.meanUs,
+                       q.latency.percentileUs(0.50), q.latency.percentileUs(0.95), q.latency.percentileUs(0.99), q.latency.maxUs);
+}
+
+} // namespace
+
+std::string SchedulerStats::format() const {
+    std::string out = std::format("[TaskScheduler] Stats over {:.0f} ms\n", windowMs);
+    format_queue(out, "async", async);
+    format_queue(out, "io", io);
+    format_queue(out, "main", main);
+    for (const auto& w : workers) {
+        out += std::format("  {}{:<3} tasks={:<8} busy={:.1f}ms idle={:.1f}ms util={:.0f}%\n",
+                           w.io ? "io" : "w", w.index, w.tasks, w.busyMs, w.idleMs, w.utilization() * 100.0);
+    }
+    return out;
+}
+
+} // namespace jaeng::async
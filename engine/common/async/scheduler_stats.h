@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jaeng::async {
+
+using SchedulerClock = std::chrono::steady_clock;
+
+// Lock-free log2 histogram of enqueue-to-start latency.
+// Bucket 0 holds samples below 1us, bucket i holds [2^(i-1), 2^i) us, the last bucket is open ended.
+class LatencyHistogram {
+public:
+    static constexpr size_t kBucketCount = 24; // Last regular bucket ends at ~4s
+
+    void record(SchedulerClock::duration latency) noexcept;
+    void reset() noexcept;
+
+    struct Snapshot {
+        std::array<uint64_t, kBucketCount> buckets{};
+        uint64_t count = 0;
+        double meanUs = 0.0;
+        double maxUs = 0.0;
+
+        // Upper bound of the bucket holding the given percentile (0..1)
+        double percentileUs(double p) const;
+    };
+    Snapshot snapshot() const noexcept;
+
+    static double bucketUpperBoundUs(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_ = 0;
+    std::atomic<uint64_t> totalNs_ = 0;
+    std::atomic<uint64_t> maxNs_ = 0;
+};
+
+struct QueueStats {
+    uint64_t enqueued = 0;
+    uint64_t executed = 0;
+    size_t depth = 0;      // Tasks waiting right now
+    size_t peakDepth = 0;  // Highest depth since the last reset
+    LatencyHistogram::Snapshot latency;
+};
+
+struct WorkerStats {
+    uint32_t index = 0;
+    bool io = false;
+    uint64_t tasks = 0;
+    double busyMs = 0.0;
+    double idleMs = 0.0;
+
+    double utilization() const { return busyMs + idleMs > 0.0 ? busyMs / (busyMs + idleMs) : 0.0; }
+};
+
+struct SchedulerStats {
+    QueueStats async;
+    QueueStats io;
+    QueueStats main;
+    std::vector<WorkerStats> workers;
+    double windowMs = 0.0; // Time covered since initialize() or the last reset
+
+    std::string format() const;
+};
+
+} // namespace jaeng::async
@@ -7,12 +7,15 @@
 
 namespace jaeng::async {
 
+class TickScheduler;
+
 template<typename T>
 struct Task {
     struct promise_type {
         std::optional<T> result;
         std::exception_ptr exception;
         std::coroutine_handle<> continuation;
+        TickScheduler* tickScheduler = nullptr; // Owner of the tick job awaiting this task, if any
 
         Task get_return_object() {
             return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
@@ -68,8 +71,12 @@ struct Task {
             return !handle || handle.done();
         }
 
-        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> continuation) noexcept {
             handle.promise().continuation = continuation;
+            if constexpr (requires { continuation.promise().tickScheduler; }) {
+                handle.promise().tickScheduler = continuation.promise().tickScheduler;
+            }
             return handle;
         }
 
@@ -91,6 +98,7 @@ struct Task<void> {
     struct promise_type {
         std::exception_ptr exception;
         std::coroutine_handle<> continuation;
+        TickScheduler* tickScheduler = nullptr; // Owner of the tick job awaiting this task, if any
 
         Task get_return_object() {
             return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
@@ -144,8 +152,12 @@ struct Task<void> {
             return !handle || handle.done();
         }
 
-        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> continuation) noexcept {
             handle.promise().continuation = continuation;
+            if constexpr (requires { continuation.promise().tickScheduler; }) {
+                handle.promise().tickScheduler = continuation.promise().tickScheduler;
+            }
             return handle;
         }
 
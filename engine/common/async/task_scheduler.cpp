@@ -1,6 +1,12 @@
 #include "task_scheduler.h"
 #include "awaiters.h"
 #include "common/logging.h"
+#include <algorithm>
+
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 
 #ifdef JAENG_APPLE
 extern "C" {
@@ -10,10 +16,27 @@ extern "C" {
 
 namespace jaeng::async {
 
-TaskScheduler::TaskScheduler() {}
+TaskScheduler::TaskScheduler() {
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) JAENG_LOG_WARN("[TaskScheduler] eventfd failed, main thread wakeups disabled");
+#endif
+}
 
 TaskScheduler::~TaskScheduler() {
     shutdown();
+    // Tasks nobody got to run; their futures are never completed
+    while (syncPending_.load(std::memory_order_acquire) > 0) {
+        if (SyncTask* node = syncQueue_.pop()) {
+            delete node;
+            syncPending_.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+    if (wakeFd_ >= 0) close(wakeFd_);
+#endif
 }
 
 void TaskScheduler::initialize(uint32_t workerCount, uint32_t ioWorkerCount) {
@@ -24,17 +47,29 @@ void TaskScheduler::initialize(uint32_t workerCount, uint32_t ioWorkerCount) {
     }
 
     stop_ = false;
+    workerCounters_.clear();
+    for (uint32_t i = 0; i < workerCount + ioWorkerCount; ++i) {
+        workerCounters_.push_back(std::make_unique<WorkerCounters>());
+    }
+    reset_stats();
+    lastStatsDump_ = SchedulerClock::now();
+
     for (uint32_t i = 0; i < workerCount; ++i) {
-        workers_.emplace_back(&TaskScheduler::worker_loop, this);
+        workers_.emplace_back(&TaskScheduler::worker_loop, this, i);
     }
     
     for (uint32_t i = 0; i < ioWorkerCount; ++i) {
-        ioWorkers_.emplace_back(&TaskScheduler::io_worker_loop, this);
+        ioWorkers_.emplace_back(&TaskScheduler::io_worker_loop, this, i);
     }
     
     JAENG_LOG_INFO("TaskScheduler initialized with {} compute workers and {} IO workers", workerCount, ioWorkerCount);
 }
 
+void TaskScheduler::initialize(const AffinityPlan& plan) {
+    affinity_ = plan;
+    initialize(std::max(1u, plan.worker_count()), plan.ioWorkerCount);
+}
+
 void TaskScheduler::shutdown() {
     {
         std::lock_guard<std::mutex> lockAsync(asyncMutex_);
@@ -53,31 +88,134 @@ void TaskScheduler::shutdown() {
         if (worker.joinable()) worker.join();
     }
     ioWorkers_.clear();
+    affinity_ = {};
     
     JAENG_LOG_INFO("TaskScheduler shut down");
 }
 
 bool TaskScheduler::process_main_thread_tasks() {
-    std::deque<TaskFn> readyTasks;
-    {
-        std::lock_guard<std::mutex> lock(syncMutex_);
-        if (syncQueue_.empty()) return false;
-        readyTasks.swap(syncQueue_);
+    if (statsDumpInterval_.count() > 0 && SchedulerClock::now() - lastStatsDump_ >= statsDumpInterval_) {
+        lastStatsDump_ = SchedulerClock::now();
+        dump_stats();
     }
 
-    for (auto& task : readyTasks) {
-#ifdef JAENG_APPLE
-        jaeng_apple_run_in_autorelease_pool([](void* ctx) {
-            auto* t = static_cast<TaskFn*>(ctx);
-            if (*t) (*t)();
-        }, &task);
-#else
-        if (task) task();
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+    if (wakeFd_ >= 0) {
+        uint64_t value;
+        [[maybe_unused]] auto n = read(wakeFd_, &value, sizeof(value)); // Reset, EAGAIN when not signalled
+    }
 #endif
+
+    // Only run what was queued on entry, tasks queued by these tasks wait for the next call
+    size_t count = syncPending_.load(std::memory_order_acquire);
+    if (count == 0) return false;
+
+    for (size_t i = 0; i < count; ++i) {
+        SyncTask* node = syncQueue_.pop();
+        while (!node) {
+            // A producer is between its two stores, the element shows up momentarily
+            std::this_thread::yield();
+            node = syncQueue_.pop();
+        }
+        syncCounters_.on_start(node->task, SchedulerClock::now());
+        run_task(node->task);
+        delete node;
+        syncPending_.fetch_sub(1, std::memory_order_acq_rel);
     }
+
+    // Producers only signal on the empty -> non-empty transition, so hand leftovers to the next wait
+    if (syncPending_.load(std::memory_order_acquire) > 0) signal_main_thread();
     return true;
 }
 
+void TaskScheduler::push_sync(SyncTask* node) {
+    size_t depth = syncPending_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    syncQueue_.push(node);
+    syncCounters_.on_enqueue(depth);
+    if (depth == 1) signal_main_thread();
+}
+
+void TaskScheduler::signal_main_thread() {
+#if defined(JAENG_LINUX) || defined(JAENG_ANDROID)
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        [[maybe_unused]] auto n = write(wakeFd_, &one, sizeof(one));
+    }
+#endif
+}
+
+void TaskScheduler::QueueCounters::reset() {
+    enqueued.store(0, std::memory_order_relaxed);
+    executed.store(0, std::memory_order_relaxed);
+    peakDepth = 0;
+    latency.reset();
+}
+
+QueueStats TaskScheduler::QueueCounters::snapshot(size_t depth) const {
+    QueueStats s;
+    s.enqueued = enqueued.load(std::memory_order_relaxed);
+    s.executed = executed.load(std::memory_order_relaxed);
+    s.depth = depth;
+    s.peakDepth = peakDepth;
+    s.latency = latency.snapshot();
+    return s;
+}
+
+static int64_t to_ns(SchedulerClock::duration d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+SchedulerStats TaskScheduler::stats() {
+    SchedulerStats s;
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex_);
+        s.async = asyncCounters_.snapshot(asyncQueue_.size());
+    }
+    {
+        std::lock_guard<std::mutex> lock(ioMutex_);
+        s.io = ioCounters_.snapshot(ioQueue_.size());
+    }
+    s.main = syncCounters_.snapshot(syncPending_.load(std::memory_order_relaxed));
+
+    const size_t computeCount = workerCounters_.size() - std::min(workerCounters_.size(), ioWorkers_.size());
+    for (size_t i = 0; i < workerCounters_.size(); ++i) {
+        const auto& c = *workerCounters_[i];
+        WorkerStats w;
+        w.io = i >= computeCount;
+        w.index = static_cast<uint32_t>(w.io ? i - computeCount : i);
+        w.tasks = c.tasks.load(std::memory_order_relaxed);
+        w.busyMs = static_cast<double>(c.busyNs.load(std::memory_order_relaxed)) / 1e6;
+        w.idleMs = static_cast<double>(c.idleNs.load(std::memory_order_relaxed)) / 1e6;
+        s.workers.push_back(w);
+    }
+
+    s.windowMs = static_cast<double>(to_ns(SchedulerClock::now().time_since_epoch()) - statsEpochNs_.load()) / 1e6;
+    return s;
+}
+
+void TaskScheduler::reset_stats() {
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex_);
+        asyncCounters_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(ioMutex_);
+        ioCounters_.reset();
+    }
+    syncCounters_.reset();
+    // Busy/idle time of a task or wait spanning the reset is attributed to the new window
+    for (auto& c : workerCounters_) {
+        c->tasks.store(0, std::memory_order_relaxed);
+        c->busyNs.store(0, std::memory_order_relaxed);
+        c->idleNs.store(0, std::memory_order_relaxed);
+    }
+    statsEpochNs_ = to_ns(SchedulerClock::now().time_since_epoch());
+}
+
+void TaskScheduler::dump_stats() {
+    JAENG_LOG_INFO("{}", stats().format());
+}
+
 thread_local bool t_isWorker = false;
 thread_local bool t_isIO = false;
 
@@ -93,12 +231,30 @@ struct TaskWrapper {
     TaskFn* task;
 };
 
-void TaskScheduler::worker_loop() {
+void TaskScheduler::run_task(QueuedTask& task) {
+#ifdef JAENG_APPLE
+    jaeng_apple_run_in_autorelease_pool([](void* ctx) {
+        auto* t = static_cast<TaskFn*>(ctx);
+        if (*t) (*t)();
+    }, &task.fn);
+#else
+    if (task.fn) task.fn();
+#endif
+}
+
+void TaskScheduler::worker_loop(uint32_t index) {
     t_isWorker = true;
     set_current_scheduler(this);
-    JAENG_LOG_INFO("[TaskScheduler] Worker thread started");
+    if (index < affinity_.workers.size() && !affinity_.workers[index].empty()) {
+        if (!set_current_thread_affinity(affinity_.workers[index])) {
+            JAENG_LOG_WARN("[TaskScheduler] Failed to pin worker {} to CPU {}", index, affinity_.workers[index].front());
+        }
+    }
+    JAENG_LOG_INFO("[TaskScheduler] Worker thread {} started", index);
+    WorkerCounters& counters = *workerCounters_[index];
+    auto idleSince = SchedulerClock::now();
     while (true) {
-        TaskFn task;
+        QueuedTask task;
         {
             std::unique_lock<std::mutex> lock(asyncMutex_);
             asyncCv_.wait(lock, [this]() { return stop_ || !asyncQueue_.empty(); });
@@ -112,25 +268,30 @@ void TaskScheduler::worker_loop() {
             asyncQueue_.pop_front();
         }
 
-#ifdef JAENG_APPLE
-        // JAENG_LOG_DEBUG("[TaskScheduler] Running task in autorelease pool");
-        jaeng_apple_run_in_autorelease_pool([](void* ctx) {
-            auto* t = static_cast<TaskFn*>(ctx);
-            if (*t) (*t)();
-        }, &task);
-#else
-        if (task) task();
-#endif
+        auto start = SchedulerClock::now();
+        asyncCounters_.on_start(task, start);
+        counters.idleNs.fetch_add(to_ns(start - idleSince), std::memory_order_relaxed);
+
+        run_task(task);
+
+        idleSince = SchedulerClock::now();
+        counters.busyNs.fetch_add(to_ns(idleSince - start), std::memory_order_relaxed);
+        counters.tasks.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
-void TaskScheduler::io_worker_loop() {
+void TaskScheduler::io_worker_loop(uint32_t index) {
     t_isWorker = true;
     t_isIO = true;
     set_current_scheduler(this);
+    if (!set_current_thread_affinity(affinity_.io)) {
+        JAENG_LOG_WARN("[TaskScheduler] Failed to pin IO worker");
+    }
     JAENG_LOG_INFO("[TaskScheduler] IO worker thread started");
+    WorkerCounters& counters = *workerCounters_[workers_.size() + index];
+    auto idleSince = SchedulerClock::now();
     while (true) {
-        TaskFn task;
+        QueuedTask task;
         {
             std::unique_lock<std::mutex> lock(ioMutex_);
             ioCv_.wait(lock, [this]() { return stop_ || !ioQueue_.empty(); });
@@ -144,14 +305,15 @@ void TaskScheduler::io_worker_loop() {
             ioQueue_.pop_front();
         }
 
-#ifdef JAENG_APPLE
-        jaeng_apple_run_in_autorelease_pool([](void* ctx) {
-            auto* t = static_cast<TaskFn*>(ctx);
-            if (*t) (*t)();
-        }, &task);
-#else
-        if (task) task();
-#endif
+        auto start = SchedulerClock::now();
+        ioCounters_.on_start(task, start);
+        counters.idleNs.fetch_add(to_ns(start - idleSince), std::memory_order_relaxed);
+
+        run_task(task);
+
+        idleSince = SchedulerClock::now();
+        counters.busyNs.fetch_add(to_ns(idleSince - start), std::memory_order_relaxed);
+        counters.tasks.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
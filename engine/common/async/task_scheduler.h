@@ -8,8 +8,13 @@
 #include <deque>
 #include <atomic>
 #include <future>
+#include <algorithm>
 #include <memory>
 #include "task.h"
+#include "cancellation.h"
+#include "cpu_topology.h"
+#include "scheduler_stats.h"
+#include "mpsc_queue.h"
 #include "common/logging.h"
 
 namespace jaeng::async {
@@ -162,12 +167,20 @@ DetachedTask spawn_task_impl(Task<T> task) {
 // A lightweight type-erased task
 using TaskFn = std::function<void()>;
 
+// Queue entry, stamped on enqueue so workers can measure how long it waited
+struct QueuedTask {
+    TaskFn fn;
+    SchedulerClock::time_point enqueuedAt;
+};
+
 class TaskScheduler {
 public:
     TaskScheduler();
     ~TaskScheduler();
 
     void initialize(uint32_t workerCount = 0, uint32_t ioWorkerCount = 1);
+    // Spawns one worker per plan entry and pins each worker/IO thread to its CPU set
+    void initialize(const AffinityPlan& plan);
     void shutdown();
 
     // Spawns a coroutine as a fire-and-forget task
@@ -181,95 +194,182 @@ public:
 
     // Enqueue a task to be executed on any worker thread
     template<typename F, typename... Args>
+        requires (!std::is_same_v<std::remove_cvref_t<F>, CancellationToken>)
     auto enqueue_async(F&& f, Args&&... args) -> Future<std::invoke_result_t<F, Args...>> {
+        return push_async(CancellationToken{}, std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // Same as above, but the task is dropped if the token is cancelled before a worker picks it up:
+    // its future completes with cancelled_error(), so only result<T> and void tasks can be cancelled
+    template<typename F, typename... Args>
+    auto enqueue_async(CancellationToken token, F&& f, Args&&... args) -> Future<std::invoke_result_t<F, Args...>> {
+        static_assert(is_cancellable_v<std::invoke_result_t<F, Args...>>, "Cancellable tasks must return result<T> or void");
+        return push_async(std::move(token), std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // Enqueue an IO task to be executed on dedicated IO thread(s)
+    template<typename F, typename... Args>
+        requires (!std::is_same_v<std::remove_cvref_t<F>, CancellationToken>)
+    auto enqueue_io(F&& f, Args&&... args) -> Future<std::invoke_result_t<F, Args...>> {
+        return push_io(CancellationToken{}, std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template<typename F, typename... Args>
+    auto enqueue_io(CancellationToken token, F&& f, Args&&... args) -> Future<std::invoke_result_t<F, Args...>> {
+        static_assert(is_cancellable_v<std::invoke_result_t<F, Args...>>, "Cancellable tasks must return result<T> or void");
+        return push_io(std::move(token), std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // Enqueue a task to be executed on the Main/OS thread
+    template<typename F, typename... Args>
+    auto enqueue_sync(F&& f, Args&&... args) -> Future<std::invoke_result_t<F, Args...>> {
+        using return_type = std::invoke_result_t<F, Args...>;
+        auto shared = std::make_shared<typename Future<return_type>::SharedState>();
+
+        if (stop_) throw std::runtime_error("TaskScheduler is stopped");
+        push_sync(new SyncTask{{}, {make_task(shared, CancellationToken{}, std::forward<F>(f), std::forward<Args>(args)...), SchedulerClock::now()}});
+        return Future<return_type>(shared);
+    }
+
+    // Returns true if any tasks were processed.
+    // Also logs the scheduler stats when a dump interval is set and it has elapsed.
+    bool process_main_thread_tasks();
+
+    // Readable (eventfd) whenever the main mailbox has work, so the OS event loop can sleep on it
+    // together with its input fds. -1 where the platform has no eventfd.
+    int main_thread_wakeup_fd() const { return wakeFd_; }
+
+    bool is_worker_thread() const;
+    bool is_io_thread() const;
+    // Compute workers running (0 before initialize / after shutdown)
+    size_t worker_count() const { return stop_ ? 0 : workers_.size(); }
+
+    // Telemetry: per-queue counters and latency histograms, per-worker busy/idle time.
+    // Counters are relaxed atomics, so a snapshot taken while workers run is approximate.
+    SchedulerStats stats();
+    void reset_stats();
+    void dump_stats();
+    // Periodically dump stats from process_main_thread_tasks, zero disables
+    void set_stats_dump_interval(std::chrono::milliseconds interval) { statsDumpInterval_ = interval; }
+
+private:
+    struct QueueCounters {
+        std::atomic<uint64_t> enqueued = 0;
+        std::atomic<uint64_t> executed = 0;
+        std::atomic<size_t> peakDepth = 0;
+        LatencyHistogram latency;
+
+        void on_enqueue(size_t depth) {
+            enqueued.fetch_add(1, std::memory_order_relaxed);
+            size_t peak = peakDepth.load(std::memory_order_relaxed);
+            while (depth > peak && !peakDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {}
+        }
+        void on_start(const QueuedTask& task, SchedulerClock::time_point now) {
+            executed.fetch_add(1, std::memory_order_relaxed);
+            latency.record(now - task.enqueuedAt);
+        }
+        void reset();
+        QueueStats snapshot(size_t depth) const;
+    };
+
+    // Written only by the owning worker
+    struct WorkerCounters {
+        std::atomic<uint64_t> tasks = 0;
+        std::atomic<int64_t> busyNs = 0;
+        std::atomic<int64_t> idleNs = 0;
+    };
+
+    template<typename F, typename... Args>
+    auto push_async(CancellationToken token, F&& f, Args&&... args) -> Future<std::invoke_result_t<F, Args...>> {
         using return_type = std::invoke_result_t<F, Args...>;
         auto shared = std::make_shared<typename Future<return_type>::SharedState>();
 
         {
             std::lock_guard<std::mutex> lock(asyncMutex_);
             if (stop_) throw std::runtime_error("TaskScheduler is stopped");
-            asyncQueue_.emplace_back([f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...), shared]() mutable {
-                if constexpr (std::is_void_v<return_type>) {
-                    std::apply(f, std::move(args));
-                    shared->set_value();
-                } else {
-                    shared->set_value(std::apply(f, std::move(args)));
-                }
-            });
+            asyncQueue_.push_back({make_task(shared, std::move(token), std::forward<F>(f), std::forward<Args>(args)...), SchedulerClock::now()});
+            asyncCounters_.on_enqueue(asyncQueue_.size());
         }
         asyncCv_.notify_one();
         return Future<return_type>(shared);
     }
 
-    // Enqueue an IO task to be executed on dedicated IO thread(s)
     template<typename F, typename... Args>
-    auto enqueue_io(F&& f, Args&&... args) -> Future<std::invoke_result_t<F, Args...>> {
+    auto push_io(CancellationToken token, F&& f, Args&&... args) -> Future<std::invoke_result_t<F, Args...>> {
         using return_type = std::invoke_result_t<F, Args...>;
         auto shared = std::make_shared<typename Future<return_type>::SharedState>();
 
         {
             std::lock_guard<std::mutex> lock(ioMutex_);
             if (stop_) throw std::runtime_error("TaskScheduler is stopped");
-            ioQueue_.emplace_back([f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...), shared]() mutable {
-                if constexpr (std::is_void_v<return_type>) {
-                    std::apply(f, std::move(args));
-                    shared->set_value();
-                } else {
-                    shared->set_value(std::apply(f, std::move(args)));
-                }
-            });
+            ioQueue_.push_back({make_task(shared, std::move(token), std::forward<F>(f), std::forward<Args>(args)...), SchedulerClock::now()});
+            ioCounters_.on_enqueue(ioQueue_.size());
         }
         ioCv_.notify_one();
         return Future<return_type>(shared);
     }
 
-    // Enqueue a task to be executed on the Main/OS thread
-    template<typename F, typename... Args>
-    auto enqueue_sync(F&& f, Args&&... args) -> Future<std::invoke_result_t<F, Args...>> {
+    // Wraps a callable so it completes the shared state, or skips it when cancelled before it runs
+    template<typename State, typename F, typename... Args>
+    static TaskFn make_task(std::shared_ptr<State> shared, CancellationToken token, F&& f, Args&&... args) {
         using return_type = std::invoke_result_t<F, Args...>;
-        auto shared = std::make_shared<typename Future<return_type>::SharedState>();
-
-        {
-            std::lock_guard<std::mutex> lock(syncMutex_);
-            if (stop_) throw std::runtime_error("TaskScheduler is stopped");
-            syncQueue_.emplace_back([f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...), shared]() mutable {
-                if constexpr (std::is_void_v<return_type>) {
-                    std::apply(f, std::move(args));
-                    shared->set_value();
-                } else {
-                    shared->set_value(std::apply(f, std::move(args)));
+        return [f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...), shared = std::move(shared),
+                token = std::move(token)]() mutable {
+            if constexpr (std::is_void_v<return_type>) {
+                if (!token.is_cancelled()) std::apply(f, std::move(args));
+                shared->set_value();
+            } else if constexpr (is_result<return_type>::value) {
+                if (token.is_cancelled()) {
+                    shared->set_value(return_type(cancelled_error()));
+                    return;
                 }
-            });
-        }
-        return Future<return_type>(shared);
+                shared->set_value(std::apply(f, std::move(args)));
+            } else {
+                // Submitted without a token, see enqueue_async
+                shared->set_value(std::apply(f, std::move(args)));
+            }
+        };
     }
 
-    // Returns true if any tasks were processed
-    bool process_main_thread_tasks();
+    struct SyncTask : MpscNode {
+        QueuedTask task;
+    };
+    void push_sync(SyncTask* node);
+    void signal_main_thread();
 
-    bool is_worker_thread() const;
-    bool is_io_thread() const;
+    void worker_loop(uint32_t index);
+    void io_worker_loop(uint32_t index);
+    static void run_task(QueuedTask& task);
 
-private:
-    void worker_loop();
-    void io_worker_loop();
+    AffinityPlan affinity_;
 
     std::vector<std::thread> workers_;
     std::vector<std::thread> ioWorkers_;
     
     // Async Queue (MPMC)
-    std::deque<TaskFn> asyncQueue_;
+    std::deque<QueuedTask> asyncQueue_;
     std::mutex asyncMutex_;
     std::condition_variable asyncCv_;
+    QueueCounters asyncCounters_;
 
     // IO Queue (MPMC)
-    std::deque<TaskFn> ioQueue_;
+    std::deque<QueuedTask> ioQueue_;
     std::mutex ioMutex_;
     std::condition_variable ioCv_;
-
-    // Sync Mailbox (MPSC)
-    std::deque<TaskFn> syncQueue_;
-    std::mutex syncMutex_;
+    QueueCounters ioCounters_;
+
+    // Sync Mailbox (MPSC, lock-free). syncPending_ counts pushed but not yet run tasks; the
+    // producer that takes it from zero signals wakeFd_.
+    MpscQueue<SyncTask> syncQueue_;
+    std::atomic<size_t> syncPending_ = 0;
+    QueueCounters syncCounters_;
+    int wakeFd_ = -1;
+
+    // Compute workers first, then IO workers. Sized in initialize() before any thread starts.
+    std::vector<std::unique_ptr<WorkerCounters>> workerCounters_;
+    std::atomic<int64_t> statsEpochNs_ = 0;
+    std::chrono::milliseconds statsDumpInterval_{0};
+    SchedulerClock::time_point lastStatsDump_;
 
     std::atomic<bool> stop_ = false;
 };
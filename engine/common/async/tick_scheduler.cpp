@@ -0,0 +1,87 @@
+#include "tick_scheduler.h"
+
+namespace jaeng::async {
+
+static thread_local TickScheduler* t_currentTickScheduler = nullptr;
+
+TickScheduler::~TickScheduler() {
+    clear();
+}
+
+TickScheduler* TickScheduler::current() {
+    return t_currentTickScheduler;
+}
+
+void TickScheduler::Enter::await_suspend(std::coroutine_handle<Job::promise_type> h) {
+    root = h;
+    h.promise().tickScheduler = self;
+    std::lock_guard<std::mutex> lock(self->mutex_);
+    self->roots_.insert(h.address());
+    self->nextTick_.push_back(h);
+}
+
+void TickScheduler::finish_job(std::coroutine_handle<> root) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    roots_.erase(root.address());
+}
+
+void TickScheduler::schedule_next_tick(std::coroutine_handle<> h) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nextTick_.push_back(h);
+}
+
+size_t TickScheduler::job_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return roots_.size();
+}
+
+void TickScheduler::run_tick(std::chrono::microseconds budget) {
+    auto start = Clock::now();
+    deadline_ = start + budget;
+    stats_ = {};
+
+    // Jobs left over from the last tick run first, then the ones that asked for this tick
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.insert(ready_.end(), nextTick_.begin(), nextTick_.end());
+        nextTick_.clear();
+    }
+
+    auto* previous = std::exchange(t_currentTickScheduler, this);
+    while (!ready_.empty() && Clock::now() < deadline_) {
+        auto h = ready_.front();
+        ready_.pop_front();
+        h.resume();
+        ++stats_.resumed;
+    }
+    t_currentTickScheduler = previous;
+
+    auto end = Clock::now();
+    stats_.usedMs = std::chrono::duration<double, std::milli>(end - start).count();
+    stats_.overBudget = end > deadline_;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.pending = ready_.size() + nextTick_.size();
+    }
+    deadline_ = Clock::time_point::max();
+}
+
+void TickScheduler::clear() {
+    std::unordered_set<void*> roots;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        roots.swap(roots_);
+        nextTick_.clear();
+    }
+    ready_.clear();
+
+    // Destroying the job frame destroys the Task it awaits, and with it any nested frames
+    for (void* address : roots) {
+        std::coroutine_handle<>::from_address(address).destroy();
+    }
+    if (!roots.empty()) {
+        JAENG_LOG_INFO("[TickScheduler] Dropped {} unfinished jobs", roots.size());
+    }
+}
+
+} // namespace jaeng::async
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+#include "task.h"
+#include "task_scheduler.h"
+
+namespace jaeng::async {
+
+// Time-sliced coroutine jobs on the simulation thread.
+// Jobs are resumed by run_tick() until the per-tick budget is spent; whatever is left over
+// continues on the next tick. Jobs split their work with NextTick / YieldIfOverBudget, and
+// can hop back onto the sim thread with ResumeOnTick after awaiting work on other threads.
+// Every Task a job awaits records the job's scheduler, so NextTick / YieldIfOverBudget also
+// return to the sim thread when the job was resumed elsewhere.
+class TickScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct TickStats {
+        uint32_t resumed = 0;   // Coroutine resumptions during the last run_tick()
+        size_t pending = 0;     // Jobs still waiting to be resumed on a later tick
+        double usedMs = 0.0;
+        bool overBudget = false;
+    };
+
+    TickScheduler() = default;
+    ~TickScheduler();
+
+    TickScheduler(const TickScheduler&) = delete;
+    TickScheduler& operator=(const TickScheduler&) = delete;
+
+    // Starts a job on the next tick. Thread-safe.
+    template<typename T>
+    void spawn(Task<T> task) {
+        run_job(std::move(task));
+    }
+
+    // Resumes queued jobs until the budget is used up. Call once per fixed step on the sim thread.
+    void run_tick(std::chrono::microseconds budget);
+
+    // Destroys every job that has not finished yet. Only call when no job can be resumed anymore.
+    void clear();
+
+    const TickStats& last_tick_stats() const { return stats_; }
+    size_t job_count() const;
+
+    // The scheduler whose run_tick() is on the stack of this thread, if any
+    static TickScheduler* current();
+    bool over_budget() const { return Clock::now() >= deadline_; }
+
+    // Queues a suspended coroutine for the next tick. Thread-safe.
+    void schedule_next_tick(std::coroutine_handle<> h);
+
+private:
+    // Root frame of a job, its scheduler is passed down to the tasks it awaits
+    struct Job {
+        struct promise_type {
+            TickScheduler* tickScheduler = nullptr;
+            Job get_return_object() { return {}; }
+            std::suspend_never initial_suspend() { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void unhandled_exception() { std::terminate(); }
+            void return_void() {}
+        };
+    };
+
+    // Registers the job frame and queues it for the next tick, yields the frame handle
+    struct Enter {
+        TickScheduler* self;
+        std::coroutine_handle<> root;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<Job::promise_type> h);
+        std::coroutine_handle<> await_resume() const noexcept { return root; }
+    };
+
+    template<typename T>
+    Job run_job(Task<T> task) {
+        auto root = co_await Enter{this, {}};
+        try {
+            co_await task;
+        } catch (const std::exception& e) {
+            JAENG_LOG_ERROR("[TickScheduler] Job failed: {}", e.what());
+        } catch (...) {
+            JAENG_LOG_ERROR("[TickScheduler] Job failed with an unknown exception");
+        }
+        finish_job(root);
+    }
+
+    void finish_job(std::coroutine_handle<> root);
+
+    // Owned by the sim thread
+    std::deque<std::coroutine_handle<>> ready_;
+    Clock::time_point deadline_ = Clock::time_point::max();
+    TickStats stats_;
+
+    // Shared with other threads
+    mutable std::mutex mutex_;
+    std::deque<std::coroutine_handle<>> nextTick_;
+    std::unordered_set<void*> roots_; // Frames of the jobs still alive, for clear()
+};
+
+namespace detail {
+    // Scheduler of the tick job h runs in: recorded in the tasks the job awaits, otherwise the one
+    // running on this thread
+    template<typename P>
+    TickScheduler* tick_owner(std::coroutine_handle<P> h) {
+        if constexpr (requires { h.promise().tickScheduler; }) {
+            if (h.promise().tickScheduler) return h.promise().tickScheduler;
+        }
+        return TickScheduler::current();
+    }
+
+    // Queues h on its job's next tick. Outside of tick jobs there is nothing to wait for: logs
+    // (once) and lets h continue right away.
+    template<typename P>
+    bool suspend_to_next_tick(std::coroutine_handle<P> h, const char* awaiter) {
+        auto* owner = tick_owner(h);
+        if (!owner) {
+            static std::atomic<bool> logged = false;
+            if (!logged.exchange(true)) {
+                JAENG_LOG_WARN("[TickScheduler] {} awaited outside of a tick job, continuing without yielding", awaiter);
+            }
+            return false;
+        }
+        owner->schedule_next_tick(h);
+        return true;
+    }
+}
+
+// Suspends until the next tick, on the sim thread
+struct NextTick {
+    bool await_ready() const noexcept { return false; }
+    template<typename P>
+    bool await_suspend(std::coroutine_handle<P> h) const { return detail::suspend_to_next_tick(h, "NextTick"); }
+    void await_resume() const noexcept {}
+};
+
+// Continues right away when on the sim thread with budget left, otherwise on the next tick
+struct YieldIfOverBudget {
+    bool await_ready() const noexcept {
+        auto* s = TickScheduler::current();
+        return s != nullptr && !s->over_budget();
+    }
+    template<typename P>
+    bool await_suspend(std::coroutine_handle<P> h) const { return detail::suspend_to_next_tick(h, "YieldIfOverBudget"); }
+    void await_resume() const noexcept {}
+};
+
+// Continues on the simulation thread at the next tick, from whichever thread resumed the job
+struct ResumeOnTick {
+    TickScheduler& scheduler;
+    bool await_ready() const noexcept { return TickScheduler::current() == &scheduler; }
+    void await_suspend(std::coroutine_handle<> h) const { scheduler.schedule_next_tick(h); }
+    void await_resume() const noexcept {}
+};
+
+} // namespace jaeng::async
@@ -3,12 +3,13 @@
 #include "common/math/math.h"
 #include "ray.h"
 #include <algorithm>
+#include <limits>
 
 namespace jaeng::math {
     struct AABB {
         jaeng::math::vec3 min, max;
 
-        bool intersects(const AABB& other) {
+        bool intersects(const AABB& other) const {
             return  (min.x <= other.max.x && max.x >= other.min.x) &&
                     (min.y <= other.max.y && max.y >= other.min.y) &&
                     (min.z <= other.max.z && max.z >= other.min.z);
@@ -46,5 +47,39 @@ namespace jaeng::math {
                    p.y >= min.y && p.y <= max.y &&
                    p.z >= min.z && p.z <= max.z;
         }
+
+        jaeng::math::vec3 center() const { return (min + max) * 0.5f; }
+        jaeng::math::vec3 extents() const { return (max - min) * 0.5f; }
+
+        void merge(const AABB& other) {
+            min = jaeng::math::min(min, other.min);
+            max = jaeng::math::max(max, other.max);
+        }
+
+        // Bounds of this box after an affine transform (Arvo): each output axis takes the min/max
+        // contribution of every input axis, which is exact for the transformed box's AABB
+        AABB transformed(const jaeng::math::mat4& m) const {
+            AABB out { jaeng::math::vec3(m[3]), jaeng::math::vec3(m[3]) };
+            for (int c = 0; c < 3; ++c) {
+                jaeng::math::vec3 a = jaeng::math::vec3(m[c]) * min[c];
+                jaeng::math::vec3 b = jaeng::math::vec3(m[c]) * max[c];
+                out.min += jaeng::math::min(a, b);
+                out.max += jaeng::math::max(a, b);
+            }
+            return out;
+        }
+
+        // World space bounds of everything a view-projection can see (its frustum corners, depth 0 to 1)
+        static AABB fromViewProj(const jaeng::math::mat4& viewProj) {
+            jaeng::math::mat4 inv = jaeng::math::inverse(viewProj);
+            AABB out { jaeng::math::vec3(std::numeric_limits<float>::max()), jaeng::math::vec3(std::numeric_limits<float>::lowest()) };
+            for (int i = 0; i < 8; ++i) {
+                jaeng::math::vec4 corner = inv * jaeng::math::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : 0.0f, 1.0f);
+                jaeng::math::vec3 p = jaeng::math::vec3(corner) / corner.w;
+                out.min = jaeng::math::min(out.min, p);
+                out.max = jaeng::math::max(out.max, p);
+            }
+            return out;
+        }
     };
 }
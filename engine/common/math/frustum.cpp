@@ -0,0 +1,147 @@
+#include "frustum.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JAENG_FRUSTUM_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define JAENG_FRUSTUM_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace jaeng::math {
+
+namespace {
+
+// A box is outside a plane when its center is further behind it than its extent projected on the
+// normal reaches: dot(n, c) + d + dot(|n|, e) < 0. Doubled to work on min + max and max - min directly.
+struct PlaneTerms {
+    float n[6][3];
+    float absN[6][3];
+    float d2[6];
+};
+
+PlaneTerms planeTerms(const Frustum& frustum) {
+    PlaneTerms t;
+    for (int p = 0; p < 6; ++p) {
+        for (int a = 0; a < 3; ++a) {
+            t.n[p][a] = frustum.planes[p][a];
+            t.absN[p][a] = std::fabs(frustum.planes[p][a]);
+        }
+        t.d2[p] = 2.0f * frustum.planes[p].w;
+    }
+    return t;
+}
+
+inline const float* boxAt(const AABB* boxes, size_t i, size_t stride) {
+    return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(boxes) + i * stride);
+}
+
+inline bool visibleScalar(const PlaneTerms& t, const float* b) {
+    for (int p = 0; p < 6; ++p) {
+        float s = t.d2[p];
+        for (int a = 0; a < 3; ++a) {
+            s += t.n[p][a] * (b[a] + b[3 + a]) + t.absN[p][a] * (b[3 + a] - b[a]);
+        }
+        if (s < 0.0f) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+size_t Frustum::cull(const AABB* boxes, size_t count, uint8_t* visible, size_t stride) const {
+    static_assert(sizeof(AABB) == 6 * sizeof(float), "cull reads AABBs as six packed floats");
+
+    const PlaneTerms t = planeTerms(*this);
+    size_t i = 0;
+    size_t visibleCount = 0;
+
+#if JAENG_FRUSTUM_SSE
+    // Four boxes per step: each is loaded as floats [0..3] and [2..5] (so no read goes past the box)
+    // and the two 4x4 blocks are transposed into min/max lanes
+    for (; i + 4 <= count; i += 4) {
+        __m128 a0 = _mm_loadu_ps(boxAt(boxes, i + 0, stride));
+        __m128 a1 = _mm_loadu_ps(boxAt(boxes, i + 1, stride));
+        __m128 a2 = _mm_loadu_ps(boxAt(boxes, i + 2, stride));
+        __m128 a3 = _mm_loadu_ps(boxAt(boxes, i + 3, stride));
+        __m128 b0 = _mm_loadu_ps(boxAt(boxes, i + 0, stride) + 2);
+        __m128 b1 = _mm_loadu_ps(boxAt(boxes, i + 1, stride) + 2);
+        __m128 b2 = _mm_loadu_ps(boxAt(boxes, i + 2, stride) + 2);
+        __m128 b3 = _mm_loadu_ps(boxAt(boxes, i + 3, stride) + 2);
+        _MM_TRANSPOSE4_PS(a0, a1, a2, a3);  // min.x, min.y, min.z, max.x
+        _MM_TRANSPOSE4_PS(b0, b1, b2, b3);  // min.z, max.x, max.y, max.z
+
+        const __m128 sum[3] = { _mm_add_ps(a0, a3), _mm_add_ps(a1, b2), _mm_add_ps(a2, b3) };
+        const __m128 diff[3] = { _mm_sub_ps(a3, a0), _mm_sub_ps(b2, a1), _mm_sub_ps(b3, a2) };
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 s = _mm_set1_ps(t.d2[p]);
+            for (int a = 0; a < 3; ++a) {
+                s = _mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(t.n[p][a]), sum[a]));
+                s = _mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(t.absN[p][a]), diff[a]));
+            }
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(s, _mm_setzero_ps()));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; ++lane) {
+            uint8_t v = static_cast<uint8_t>((mask >> lane) & 1);
+            visible[i + lane] = v;
+            visibleCount += v;
+        }
+    }
+#elif JAENG_FRUSTUM_NEON
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t r0 = vld1q_f32(boxAt(boxes, i + 0, stride));
+        float32x4_t r1 = vld1q_f32(boxAt(boxes, i + 1, stride));
+        float32x4_t r2 = vld1q_f32(boxAt(boxes, i + 2, stride));
+        float32x4_t r3 = vld1q_f32(boxAt(boxes, i + 3, stride));
+        float32x4_t q0 = vld1q_f32(boxAt(boxes, i + 0, stride) + 2);
+        float32x4_t q1 = vld1q_f32(boxAt(boxes, i + 1, stride) + 2);
+        float32x4_t q2 = vld1q_f32(boxAt(boxes, i + 2, stride) + 2);
+        float32x4_t q3 = vld1q_f32(boxAt(boxes, i + 3, stride) + 2);
+
+        float32x4x2_t r01 = vtrnq_f32(r0, r1), r23 = vtrnq_f32(r2, r3);
+        float32x4x2_t q01 = vtrnq_f32(q0, q1), q23 = vtrnq_f32(q2, q3);
+        float32x4_t minX = vcombine_f32(vget_low_f32(r01.val[0]), vget_low_f32(r23.val[0]));
+        float32x4_t minY = vcombine_f32(vget_low_f32(r01.val[1]), vget_low_f32(r23.val[1]));
+        float32x4_t minZ = vcombine_f32(vget_high_f32(r01.val[0]), vget_high_f32(r23.val[0]));
+        float32x4_t maxX = vcombine_f32(vget_high_f32(r01.val[1]), vget_high_f32(r23.val[1]));
+        float32x4_t maxY = vcombine_f32(vget_high_f32(q01.val[0]), vget_high_f32(q23.val[0]));
+        float32x4_t maxZ = vcombine_f32(vget_high_f32(q01.val[1]), vget_high_f32(q23.val[1]));
+
+        const float32x4_t sum[3] = { vaddq_f32(minX, maxX), vaddq_f32(minY, maxY), vaddq_f32(minZ, maxZ) };
+        const float32x4_t diff[3] = { vsubq_f32(maxX, minX), vsubq_f32(maxY, minY), vsubq_f32(maxZ, minZ) };
+
+        uint32x4_t inside = vdupq_n_u32(~0u);
+        for (int p = 0; p < 6; ++p) {
+            float32x4_t s = vdupq_n_f32(t.d2[p]);
+            for (int a = 0; a < 3; ++a) {
+                s = vmlaq_f32(s, vdupq_n_f32(t.n[p][a]), sum[a]);
+                s = vmlaq_f32(s, vdupq_n_f32(t.absN[p][a]), diff[a]);
+            }
+            inside = vandq_u32(inside, vcgeq_f32(s, vdupq_n_f32(0.0f)));
+        }
+
+        uint32_t lanes[4];
+        vst1q_u32(lanes, inside);
+        for (int lane = 0; lane < 4; ++lane) {
+            uint8_t v = lanes[lane] ? 1 : 0;
+            visible[i + lane] = v;
+            visibleCount += v;
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        uint8_t v = visibleScalar(t, boxAt(boxes, i, stride)) ? 1 : 0;
+        visible[i] = v;
+        visibleCount += v;
+    }
+    return visibleCount;
+}
+
+} // namespace jaeng::math
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common/math/math.h"
+#include "aabb.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace jaeng::math {
+    // The six planes bounding what a view-projection sees. Each plane is (normal, distance) with the
+    // normal pointing inwards: a point p is inside when dot(normal, p) + distance >= 0 for all of them.
+    struct Frustum {
+        enum Side { Left, Right, Bottom, Top, Near, Far };
+        enum class Result { Outside, Intersects, Inside };
+
+        std::array<jaeng::math::vec4, 6> planes;
+        AABB bounds;  // World bounds of the frustum corners, for structures indexed by position
+
+        // Gribb-Hartmann plane extraction for the engine's 0 to 1 clip depth
+        static Frustum fromViewProj(const jaeng::math::mat4& m) {
+            auto row = [&m](int i) { return jaeng::math::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+            Frustum f;
+            f.planes[Left]   = row(3) + row(0);
+            f.planes[Right]  = row(3) - row(0);
+            f.planes[Bottom] = row(3) + row(1);
+            f.planes[Top]    = row(3) - row(1);
+            f.planes[Near]   = row(2);
+            f.planes[Far]    = row(3) - row(2);
+            for (auto& p : f.planes) {
+                float len = jaeng::math::length(jaeng::math::vec3(p));
+                if (len > 0.0f) p /= len;
+            }
+            f.bounds = AABB::fromViewProj(m);
+            return f;
+        }
+
+        // Tests the box corner furthest along each plane normal, and for Inside the nearest one too
+        Result classify(const AABB& box) const {
+            Result result = Result::Inside;
+            for (const auto& p : planes) {
+                jaeng::math::vec3 n(p);
+                jaeng::math::vec3 far(n.x >= 0.0f ? box.max.x : box.min.x, n.y >= 0.0f ? box.max.y : box.min.y, n.z >= 0.0f ? box.max.z : box.min.z);
+                if (jaeng::math::dot(n, far) + p.w < 0.0f) return Result::Outside;
+                jaeng::math::vec3 near(n.x >= 0.0f ? box.min.x : box.max.x, n.y >= 0.0f ? box.min.y : box.max.y, n.z >= 0.0f ? box.min.z : box.max.z);
+                if (jaeng::math::dot(n, near) + p.w < 0.0f) result = Result::Intersects;
+            }
+            return result;
+        }
+
+        // Conservative: boxes crossing a frustum corner outside of it may still pass
+        bool intersects(const AABB& box) const {
+            for (const auto& p : planes) {
+                jaeng::math::vec3 n(p);
+                jaeng::math::vec3 far(n.x >= 0.0f ? box.max.x : box.min.x, n.y >= 0.0f ? box.max.y : box.min.y, n.z >= 0.0f ? box.max.z : box.min.z);
+                if (jaeng::math::dot(n, far) + p.w < 0.0f) return false;
+            }
+            return true;
+        }
+
+        // intersects() over many boxes, four per SIMD step (SSE2 or NEON): visible[i] is set to 1 or 0.
+        // Boxes are read stride bytes apart, so bounds stored inside larger records can be tested in
+        // place. Returns how many are visible.
+        size_t cull(const AABB* boxes, size_t count, uint8_t* visible, size_t stride = sizeof(AABB)) const;
+    };
+}
@@ -59,6 +59,7 @@ namespace jaeng::math {
     using glm::angleAxis;
     using glm::slerp;
     using glm::toMat4;
+    using glm::quat_cast;
     using glm::pi;
     using glm::half_pi;
     using glm::quarter_pi;
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "common/math/math.h"
+
+namespace jaeng::math {
+
+struct Sphere {
+    jaeng::math::vec3 center{0.0f};
+    float radius = 0.0f;
+};
+
+} // namespace jaeng::math
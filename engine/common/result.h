@@ -20,7 +20,8 @@ enum class error_code {
     invalid_operation,
     no_resource,
     resource_not_ready,
-    platform_error
+    platform_error,
+    cancelled
 };
 
 // -------------------- Error Type --------------------
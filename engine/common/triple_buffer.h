@@ -3,45 +3,53 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
 
 namespace jaeng {
 
 template <typename T>
 class TripleBuffer {
 public:
-    TripleBuffer() {
-        producer_ = &buffers_[0];
-        consumer_ = &buffers_[1];
-        shared_.store(&buffers_[2], std::memory_order_relaxed);
-    }
+    TripleBuffer() = default;
 
     // Sim Thread gets the current buffer to fill
-    T& get_producer() { return *producer_; }
+    T& get_producer() { return buffers_[producer_]; }
 
     // Sim Thread swaps the filled buffer into the shared slot
     void push_producer() {
-        producer_ = shared_.exchange(producer_, std::memory_order_acq_rel);
-        new_data_.store(true, std::memory_order_release);
+        producer_ = shared_.exchange(producer_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Sim Thread publishes the filled buffer only if the Render Thread already took the previous one,
+    // so no published buffer is ever replaced unseen. Returns false and keeps the buffer otherwise,
+    // letting the producer keep appending to it (for streams of deltas).
+    bool try_push_producer() {
+        // Only the producer sets kFresh, so a consumed slot cannot change under us
+        if (shared_.load(std::memory_order_acquire) & kFresh) return false;
+        push_producer();
+        return true;
     }
 
     // Render Thread attempts to grab a new buffer. Returns true if swapped.
     bool update_consumer() {
-        if (new_data_.exchange(false, std::memory_order_acquire)) {
-            consumer_ = shared_.exchange(consumer_, std::memory_order_acq_rel);
-            return true;
-        }
-        return false;
+        if ((shared_.load(std::memory_order_relaxed) & kFresh) == 0) return false;
+        consumer_ = shared_.exchange(consumer_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
     }
 
     // Render Thread reads the safe, isolated buffer
-    const T& get_consumer() const { return *consumer_; }
+    const T& get_consumer() const { return buffers_[consumer_]; }
 
 private:
+    // Index and "not yet consumed" flag of the shared slot live in one atomic, so a swap can never
+    // pair a buffer with the flag of another one
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
     std::array<T, 3> buffers_;
-    T* producer_;
-    T* consumer_;
-    std::atomic<T*> shared_;
-    std::atomic<bool> new_data_{false};
+    uint8_t producer_ = 0;
+    uint8_t consumer_ = 1;
+    std::atomic<uint8_t> shared_{2};
 };
 
 } // namespace jaeng
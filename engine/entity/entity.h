@@ -146,6 +146,12 @@ public:
         return getPool<T>().getAllEntities();
     }
 
+    // Resolves the pool once so hot loops (and worker threads reading it) skip the pool map and its lock
+    template<typename T>
+    ComponentPool<T>& getComponentPool() {
+        return getPool<T>();
+    }
+
     void destroyEntity(EntityID id) {
         entities.erase(std::remove(entities.begin(), entities.end(), id), entities.end());
         for (auto& [type, pool] : pools) {
@@ -9,6 +9,7 @@
 #include "render/public/renderer_api.h"
 #include "common/result.h"
 #include "common/async/task.h"
+#include "common/async/cancellation.h"
 
 namespace jaeng {
 
@@ -79,6 +80,9 @@ struct MaterialMetadata {
     std::unordered_map<std::string, float> scalarParams;
     std::unordered_map<std::string, jaeng::math::vec4> vectorParams;
     std::vector<CBData> constantBuffers;
+    // Draws of this material one instanced call may pack ("maxInstances"). Above 1, CBObject must be
+    // an array of at least this many InstanceData (see Scene).
+    uint32_t maxInstances = 1;
 };
 
 struct MaterialEventListener {
@@ -91,8 +95,9 @@ public:
     // Create material from a virtual path (disk, memory, etc.)
     virtual result<MaterialHandle> createMaterial(const std::string& path) = 0;
 
-    // Create material asynchronously
-    virtual async::Task<result<MaterialHandle>> createMaterialAsync(const std::string& path) = 0;
+    // Create material asynchronously. On cancellation (or failure) the partially created material
+    // is destroyed and its handle released.
+    virtual async::Task<result<MaterialHandle>> createMaterialAsync(const std::string& path, async::CancellationToken token = {}) = 0;
 
     // Create Material from a virtual path but with hardcoded layout descriptors (from reflection)
     virtual result<MaterialHandle> createMaterial(
@@ -119,6 +124,10 @@ public:
     // Hot-reload material
     virtual result<> reloadMaterial(MaterialHandle handle) = 0;
 
+    // Incremented whenever a material becomes ready, is destroyed, reloaded or gets a new texture.
+    // Callers keeping getBindData results (or data read from them) refresh them once it changed.
+    virtual uint64_t getGeneration() const = 0;
+
     // Update material parameters
     // Event subscription for material changes
     virtual void subscribe(MaterialEventListener* listener) = 0;
@@ -22,13 +22,13 @@ extern "C" {
 }
 #endif
 
-async::Task<result<MaterialHandle>> MaterialSystem::createMaterialAsync(const std::string& path)
+async::Task<result<MaterialHandle>> MaterialSystem::createMaterialAsync(const std::string& path, async::CancellationToken token)
 {
     JAENG_LOG_DEBUG("[Material] createMaterialAsync: {}", path);
     auto fm = fileManager;
 
     MaterialHandle h;
-    JAENG_TRY_ASSIGN_ASYNC(h, _createMaterialMetadataAsync(*fm, path));
+    JAENG_TRY_ASSIGN_ASYNC(h, _createMaterialMetadataAsync(*fm, path, token));
     
     std::shared_ptr<Storage> material;
     {
@@ -37,8 +37,12 @@ async::Task<result<MaterialHandle>> MaterialSystem::createMaterialAsync(const st
     }
 
     JAENG_LOG_DEBUG("[Material] Fetching reflection for {}", material->mat.name);
-    ReflectionData rd;
-    JAENG_TRY_ASSIGN_ASYNC(rd, _loadReflectionAsync(*fm, material->mat.reflectPath));
+    auto rdRes = co_await _loadReflectionAsync(*fm, material->mat.reflectPath, token);
+    if (rdRes.hasError()) {
+        destroyMaterial(h);
+        co_return rdRes;
+    }
+    ReflectionData rd = std::move(rdRes).logError().value();
 
     // Create Resources
     JAENG_LOG_DEBUG("[Material] Creating resources for {}", material->mat.name);
@@ -46,9 +50,16 @@ async::Task<result<MaterialHandle>> MaterialSystem::createMaterialAsync(const st
     for (const auto& s : rd.semantics) semPtrs.push_back(s.c_str());
 
     VertexLayoutDesc vld { .stride = rd.stride, .attributes = rd.attributes.data(), .attribute_count = static_cast<uint32_t>(rd.attributes.size()) };
-    JAENG_TRY_ASYNC(_createMaterialResourcesAsync(*fm, *material, &vld, vld.attribute_count, semPtrs.data()));
+    auto resourcesRes = co_await _createMaterialResourcesAsync(*fm, *material, &vld, vld.attribute_count, semPtrs.data(), token);
+    if (resourcesRes.hasError() || token.is_cancelled()) {
+        // Releases whatever GPU objects were created so far together with the handle
+        destroyMaterial(h);
+        if (resourcesRes.hasError()) co_return resourcesRes;
+        co_return async::cancelled_error();
+    }
 
     JAENG_LOG_INFO("[Material] Async creation finished: {}", material->mat.name);
+    generation.fetch_add(1, std::memory_order_release);
     co_return h;
 }
 
@@ -57,10 +68,12 @@ async::Task<result<>> MaterialSystem::_createMaterialResourcesAsync(
     MaterialSystem::Storage& material,
     const VertexLayoutDesc* vtxLayout,
     size_t vtxLayoutCount,
-    const char* requiredSemantics[])
+    const char* requiredSemantics[],
+    async::CancellationToken token)
 {
     auto gfx = renderer.lock();
     JAENG_ERROR_IF_ASYNC(!gfx, error_code::resource_not_ready, "[Material] Renderer is not available.");
+    JAENG_RETURN_IF_CANCELLED_ASYNC(token);
 
     material.bg.textures.clear();
     material.bg.samplers.clear();
@@ -72,13 +85,15 @@ async::Task<result<>> MaterialSystem::_createMaterialResourcesAsync(
     // Create Shaders
     {   // Vertex Shader
         std::vector<uint8_t> data;
-        JAENG_TRY_ASSIGN_ASYNC(data, fm.loadAsync(material.mat.vsPath));
+        JAENG_TRY_ASSIGN_ASYNC(data, fm.loadAsync(material.mat.vsPath, token));
+        JAENG_RETURN_IF_CANCELLED_ASYNC(token);
         ShaderModuleDesc desc { ShaderStage::Vertex, data.data(), (uint32_t)data.size(), 0 };
         material.bg.vertexShader = gfx->create_shader_module(&desc);
     }
     {   // Pixel Shader
         std::vector<uint8_t> data;
-        JAENG_TRY_ASSIGN_ASYNC(data, fm.loadAsync(material.mat.psPath));
+        JAENG_TRY_ASSIGN_ASYNC(data, fm.loadAsync(material.mat.psPath, token));
+        JAENG_RETURN_IF_CANCELLED_ASYNC(token);
         ShaderModuleDesc desc { ShaderStage::Fragment, data.data(), (uint32_t)data.size(), 0 };
         material.bg.pixelShader = gfx->create_shader_module(&desc);
     }
@@ -91,7 +106,8 @@ async::Task<result<>> MaterialSystem::_createMaterialResourcesAsync(
     // Create Texture and Sampler Resources
     for (auto& t : material.mat.textures) {
         std::vector<uint8_t> pixels;
-        JAENG_TRY_ASSIGN_ASYNC(pixels, fm.loadAsync(t.path));
+        JAENG_TRY_ASSIGN_ASYNC(pixels, fm.loadAsync(t.path, token));
+        JAENG_RETURN_IF_CANCELLED_ASYNC(token);
         TextureDesc td{ TextureFormat::RGBA8_UNORM, t.width, t.height, 1, 1, 0 };
         TextureHandle tex = gfx->create_texture(&td, pixels.data());
         material.bg.textures.emplace_back(tex);
@@ -115,9 +131,9 @@ async::Task<result<>> MaterialSystem::_createMaterialResourcesAsync(
     co_return result<>{};
 }
 
-async::Task<result<MaterialSystem::ReflectionData>> MaterialSystem::_loadReflectionAsync(IFileManager& fm, const std::string& path) {
+async::Task<result<MaterialSystem::ReflectionData>> MaterialSystem::_loadReflectionAsync(IFileManager& fm, const std::string& path, async::CancellationToken token) {
     std::vector<uint8_t> fdata;
-    JAENG_TRY_ASSIGN_ASYNC(fdata, fm.loadAsync(path));
+    JAENG_TRY_ASSIGN_ASYNC(fdata, fm.loadAsync(path, token));
     try {
         json j = json::parse(fdata);
         ReflectionData rd;
@@ -175,6 +191,7 @@ static MaterialMetadata fromJsonInternal(const nlohmann::json& j) {
             m.constantBuffers.emplace_back(cbEntry["name"], cbEntry["size"].get<uint32_t>(), cbEntry["binding"].get<uint32_t>());
         }
     }
+    m.maxInstances = j.value("maxInstances", 1u);
     auto states = j["pipelineStates"];
     m.blendState.enabled = states["blend"].value("enabled", false);
     m.rasterizer.cullMode = states["rasterizer"].value("cullMode", "back");
@@ -183,11 +200,12 @@ static MaterialMetadata fromJsonInternal(const nlohmann::json& j) {
     return m;
 }
 
-async::Task<result<MaterialHandle>> MaterialSystem::_createMaterialMetadataAsync(IFileManager& fm, const std::string& path)
+async::Task<result<MaterialHandle>> MaterialSystem::_createMaterialMetadataAsync(IFileManager& fm, const std::string& path, async::CancellationToken token)
 {
     JAENG_ERROR_IF_ASYNC(slotUsage.count() >= MaterialSystem::MAX_MATERIALS, error_code::no_resource, "[Material] No space");
     std::vector<uint8_t> fdata;
-    JAENG_TRY_ASSIGN_ASYNC(fdata, fm.loadAsync(path));
+    JAENG_TRY_ASSIGN_ASYNC(fdata, fm.loadAsync(path, token));
+    JAENG_RETURN_IF_CANCELLED_ASYNC(token);
     try {
         auto matJson = json::parse(fdata.begin(), fdata.end());
         auto mat = fromJsonInternal(matJson);
@@ -216,6 +234,7 @@ result<MaterialHandle> MaterialSystem::createMaterial(const std::string& path)
     for (const auto& s : rd.semantics) semPtrs.push_back(s.c_str());
     VertexLayoutDesc vld { .stride = rd.stride, .attributes = rd.attributes.data(), .attribute_count = static_cast<uint32_t>(rd.attributes.size()) };
     JAENG_TRY(_createMaterialResources(*fileManager, *material, &vld, vld.attribute_count, semPtrs.data()));
+    generation.fetch_add(1, std::memory_order_release);
     return h;
 }
 
@@ -228,6 +247,7 @@ result<MaterialHandle> MaterialSystem::createMaterial(const std::string& path, c
         material = storage[h];
     }
     JAENG_TRY(_createMaterialResources(*fileManager, *material, vertexLayout, vertexLayoutCount, requiredSemantics));
+    generation.fetch_add(1, std::memory_order_release);
     return h;
 }
 
@@ -248,6 +268,7 @@ void MaterialSystem::destroyMaterial(MaterialHandle handle)
         }
         storage.erase(it);
         slotUsage.reset(handle);
+        generation.fetch_add(1, std::memory_order_release);
     }
 }
 
@@ -265,7 +286,10 @@ result<const MaterialMetadata*> MaterialSystem::getMetadata(MaterialHandle handl
     return &it->second->mat;
 }
 
-result<> MaterialSystem::reloadMaterial(MaterialHandle handle) { return result<>{}; }
+result<> MaterialSystem::reloadMaterial(MaterialHandle handle) {
+    generation.fetch_add(1, std::memory_order_release);
+    return result<>{};
+}
 
 void MaterialSystem::setVectorParam(MaterialHandle handle, const std::string& name, const glm::vec4& value) {
     std::lock_guard<std::mutex> lock(storageMutex);
@@ -404,6 +428,7 @@ void MaterialSystem::setTextureSlot(MaterialHandle handle, uint32_t slotIndex, T
             if (auto gfx = renderer.lock()) {
                 bg.textureIndices[slotIndex] = gfx->get_texture_index(texture);
             }
+            generation.fetch_add(1, std::memory_order_release);
         }
     }
 }
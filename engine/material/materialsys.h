@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <bitset>
 #include <string>
 #include <memory>
@@ -30,7 +31,7 @@ public:
 
     result<MaterialHandle> createMaterial(const std::string& path) override;
 
-    async::Task<result<MaterialHandle>> createMaterialAsync(const std::string& path) override;
+    async::Task<result<MaterialHandle>> createMaterialAsync(const std::string& path, async::CancellationToken token = {}) override;
 
     // Create Material from a virtual path but with hardcoded layout descriptors (from reflection)
     result<MaterialHandle> createMaterial(
@@ -57,6 +58,8 @@ public:
     // Hot-reload material
     result<> reloadMaterial(MaterialHandle handle) override;
 
+    uint64_t getGeneration() const override { return generation.load(std::memory_order_acquire); }
+
     // Event subscription for material changes
     void subscribe(MaterialEventListener* listener) override {}
 
@@ -75,6 +78,7 @@ private:
     std::unordered_map<MaterialHandle, std::shared_ptr<Storage>> storage;
     std::bitset<MAX_MATERIALS> slotUsage;
     mutable std::mutex storageMutex;
+    std::atomic<uint64_t> generation = 1;
     
     // Common Logic
     struct ReflectionData {
@@ -95,10 +99,10 @@ private:
     result<> _createMaterialResources(IFileManager& fm, Storage& m, const VertexLayoutDesc* vtxLayout, size_t vtxLayoutCount, 
                                              const char* requiredSemantics[]);
 
-    async::Task<result<ReflectionData>> _loadReflectionAsync(IFileManager& fm, const std::string& path);
-    async::Task<result<MaterialHandle>> _createMaterialMetadataAsync(IFileManager& fm, const std::string& path);
+    async::Task<result<ReflectionData>> _loadReflectionAsync(IFileManager& fm, const std::string& path, async::CancellationToken token);
+    async::Task<result<MaterialHandle>> _createMaterialMetadataAsync(IFileManager& fm, const std::string& path, async::CancellationToken token);
     async::Task<result<>> _createMaterialResourcesAsync(IFileManager& fm, Storage& m, const VertexLayoutDesc* vtxLayout, size_t vtxLayoutCount, 
-                                             const char* requiredSemantics[]);
+                                             const char* requiredSemantics[], async::CancellationToken token);
 };
 
 } // namespace jaeng
@@ -5,7 +5,10 @@
 
 #include "render/public/renderer_api.h"
 #include "common/result.h"
+#include "common/math/aabb.h"
+#include "common/math/sphere.h"
 #include "common/async/task.h"
+#include "common/async/cancellation.h"
 
 namespace jaeng {
 
@@ -30,12 +33,20 @@ struct Mesh {
     std::vector<std::string> semantics;
     PrimitiveTopology topology;
     size_t indexCount;
+    // Local space bounds of the vertex positions (after MeshImportDesc::uniformScale)
+    math::AABB bounds{};
+    math::Sphere sphere{};
+    // Triangle list kept on the CPU for occlusion culling, empty unless imported as an occluder
+    std::vector<math::vec3> occluderPositions;
+    std::vector<uint32_t> occluderIndices;
 };
 
 struct MeshImportDesc {
     bool calculateNormals = false;
     bool generateTangents = true;
     float uniformScale = 1.0f;
+    // Keep a CPU copy of the geometry so the scene can use the mesh to occlude others
+    bool occluder = false;
 };
 
 class IMeshSystem {
@@ -45,14 +56,20 @@ public:
     // Load mesh from file (e.g., .obj or custom format)
     virtual result<MeshHandle> loadMesh(const std::string& path, const MeshImportDesc& desc = {}) = 0;
 
-    // Load mesh asynchronously
-    virtual async::Task<result<MeshHandle>> loadMeshAsync(const std::string& path, const MeshImportDesc& desc = {}) = 0;
+    // Load mesh asynchronously. On cancellation the reserved handle is released and no GPU
+    // buffers are kept; the task completes with error_code::cancelled.
+    virtual async::Task<result<MeshHandle>> loadMeshAsync(const std::string& path, const MeshImportDesc& desc = {},
+                                                          async::CancellationToken token = {}) = 0;
 
     // Remove mesh
     virtual result<void> removeMesh(MeshHandle handle) = 0;
 
     // Get mesh for rendering
     virtual result<const Mesh*> getMesh(MeshHandle handle) const = 0;
+
+    // Incremented whenever a mesh is added or removed. Callers keeping getMesh results (or data
+    // read from them) refresh them once it changed.
+    virtual uint64_t getGeneration() const = 0;
 };
 
 } // namespace jaeng
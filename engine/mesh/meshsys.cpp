@@ -1,6 +1,9 @@
 #include "meshsys.h"
 #include "common/logging.h"
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <limits>
 #include <sstream>
 
 #define TINYOBJLOADER_IMPLEMENTATION
@@ -22,7 +25,43 @@ std::string getExtension(const std::string& path) {
     return ext;
 }
 
-result<Mesh> parseRAW(const std::vector<uint8_t>& rawData, std::shared_ptr<RendererAPI> gfx) {
+// Box around the positions, and the sphere around its center reaching the furthest vertex (a few
+// percent looser than the minimal sphere, but exact for the box's center, which culling uses)
+void computeBounds(const RAWFormatVertex* vertices, size_t count, Mesh& mesh) {
+    if (count == 0) {
+        mesh.bounds = {};
+        mesh.sphere = {};
+        return;
+    }
+
+    math::AABB box { math::vec3(std::numeric_limits<float>::max()), math::vec3(std::numeric_limits<float>::lowest()) };
+    for (size_t i = 0; i < count; ++i) {
+        math::vec3 p(vertices[i].position[0], vertices[i].position[1], vertices[i].position[2]);
+        box.min = math::min(box.min, p);
+        box.max = math::max(box.max, p);
+    }
+
+    math::vec3 center = box.center();
+    float radiusSq = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        math::vec3 d = math::vec3(vertices[i].position[0], vertices[i].position[1], vertices[i].position[2]) - center;
+        radiusSq = (std::max)(radiusSq, math::dot(d, d));
+    }
+
+    mesh.bounds = box;
+    mesh.sphere = { center, std::sqrt(radiusSq) };
+}
+
+// CPU copy of the triangles for the scene's software occlusion culling
+void copyOccluder(const RAWFormatVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, Mesh& mesh) {
+    mesh.occluderPositions.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        mesh.occluderPositions[i] = math::vec3(vertices[i].position[0], vertices[i].position[1], vertices[i].position[2]);
+    }
+    mesh.occluderIndices.assign(indices, indices + indexCount);
+}
+
+result<Mesh> parseRAW(const std::vector<uint8_t>& rawData, std::shared_ptr<RendererAPI> gfx, const MeshImportDesc& desc) {
     auto header = reinterpret_cast<const RAWFormatHeader*>(rawData.data());
     auto* vertices = reinterpret_cast<const RAWFormatVertex*>(rawData.data() + sizeof(RAWFormatHeader));
     auto* indices = reinterpret_cast<const uint32_t*>(rawData.data() + sizeof(RAWFormatHeader) + (sizeof(RAWFormatVertex)*header->vertexCount));
@@ -39,12 +78,15 @@ result<Mesh> parseRAW(const std::vector<uint8_t>& rawData, std::shared_ptr<Rende
     };
     BufferHandle ib = gfx->create_buffer(&ibd, indices);
 
-    return Mesh {
+    Mesh mesh {
         .vertexBuffer = vb, .indexBuffer = ib,
         .semantics = {"POSITION", "COLOR", "TEXCOORD"},
         .topology = PrimitiveTopology::TriangleList,
         .indexCount = header->indexCount
     };
+    computeBounds(vertices, header->vertexCount, mesh);
+    if (desc.occluder) copyOccluder(vertices, header->vertexCount, indices, header->indexCount, mesh);
+    return mesh;
 }
 
 result<Mesh> parseOBJ(const std::string& path, const std::vector<uint8_t>& rawData, std::shared_ptr<RendererAPI> gfx, const MeshImportDesc& desc) {
@@ -105,12 +147,15 @@ result<Mesh> parseOBJ(const std::string& path, const std::vector<uint8_t>& rawDa
     BufferDesc ibd{ .size_bytes = static_cast<uint32_t>(sizeof(uint32_t) * indices.size()), .usage = BufferUsage_Index };
     BufferHandle ib = gfx->create_buffer(&ibd, indices.data());
 
-    return Mesh {
+    Mesh mesh {
         .vertexBuffer = vb, .indexBuffer = ib,
         .semantics = {"POSITION", "COLOR", "TEXCOORD"},
         .topology = PrimitiveTopology::TriangleList,
         .indexCount = indices.size()
     };
+    computeBounds(vertices.data(), vertices.size(), mesh);
+    if (desc.occluder) copyOccluder(vertices.data(), vertices.size(), indices.data(), indices.size(), mesh);
+    return mesh;
 }
 
 result<Mesh> parseGLTF(const std::string& path, const std::vector<uint8_t>& rawData, std::shared_ptr<RendererAPI> gfx, const MeshImportDesc& desc) {
@@ -184,12 +229,15 @@ result<Mesh> parseGLTF(const std::string& path, const std::vector<uint8_t>& rawD
     BufferDesc ibd{ .size_bytes = static_cast<uint32_t>(sizeof(uint32_t) * indices.size()), .usage = BufferUsage_Index };
     BufferHandle ib = gfx->create_buffer(&ibd, indices.data());
 
-    return Mesh {
+    Mesh out {
         .vertexBuffer = vb, .indexBuffer = ib,
         .semantics = {"POSITION", "COLOR", "TEXCOORD"},
         .topology = PrimitiveTopology::TriangleList,
         .indexCount = indices.size()
     };
+    computeBounds(vertices.data(), vertices.size(), out);
+    if (desc.occluder) copyOccluder(vertices.data(), vertices.size(), indices.data(), indices.size(), out);
+    return out;
 }
 
 } // namespace
@@ -215,7 +263,7 @@ result<MeshHandle> MeshSystem::loadMesh(const std::string& path, const MeshImpor
     } else if (ext == ".gltf" || ext == ".glb") {
         meshRes = parseGLTF(path, rawData, gfx, desc);
     } else {
-        meshRes = parseRAW(rawData, gfx);
+        meshRes = parseRAW(rawData, gfx, desc);
     }
     
     if (meshRes.hasError()) return std::move(meshRes).logError().error();
@@ -224,15 +272,18 @@ result<MeshHandle> MeshSystem::loadMesh(const std::string& path, const MeshImpor
         std::lock_guard<std::mutex> lock(storageMutex);
         meshes.emplace(h, std::move(std::move(meshRes).logError().value()));
     }
+    generation_.fetch_add(1, std::memory_order_release);
 
     return h;
 }
 
-async::Task<result<MeshHandle>> MeshSystem::loadMeshAsync(const std::string& path, const MeshImportDesc& desc)
+async::Task<result<MeshHandle>> MeshSystem::loadMeshAsync(const std::string& path, const MeshImportDesc& desc,
+                                                          async::CancellationToken token)
 {
     auto fm = fileManager_;
     auto gfx = renderer_.lock();
     JAENG_ERROR_IF_ASYNC(!gfx, error_code::resource_not_ready, "[Mesh] Renderer is not available.");
+    JAENG_RETURN_IF_CANCELLED_ASYNC(token);
 
     MeshHandle h;
     {
@@ -242,13 +293,28 @@ async::Task<result<MeshHandle>> MeshSystem::loadMeshAsync(const std::string& pat
         h = std::move(res).logError().value();
     }
 
+    // Any early exit past this point has to give the reserved slot back
+    auto releaseSlot = [this, h]() {
+        std::lock_guard<std::mutex> lock(storageMutex);
+        freeSlot(h);
+    };
+
     std::vector<uint8_t> rawData;
     {
-        auto res = co_await fm->loadAsync(path);
-        if (res.hasError()) co_return res;
+        auto res = co_await fm->loadAsync(path, token);
+        if (res.hasError()) {
+            releaseSlot();
+            co_return res;
+        }
         rawData = std::move(res).logError().value();
     }
 
+    // Don't upload buffers nobody is waiting for
+    if (token.is_cancelled()) {
+        releaseSlot();
+        co_return async::cancelled_error();
+    }
+
     std::string ext = getExtension(path);
     result<Mesh> meshRes = Error::fromMessage((int)error_code::unknown_error, "Init");
     if (ext == ".obj") {
@@ -256,15 +322,27 @@ async::Task<result<MeshHandle>> MeshSystem::loadMeshAsync(const std::string& pat
     } else if (ext == ".gltf" || ext == ".glb") {
         meshRes = parseGLTF(path, rawData, gfx, desc);
     } else {
-        meshRes = parseRAW(rawData, gfx);
+        meshRes = parseRAW(rawData, gfx, desc);
     }
     
-    if (meshRes.hasError()) co_return std::move(meshRes).logError().error();
+    if (meshRes.hasError()) {
+        releaseSlot();
+        co_return std::move(meshRes).logError().error();
+    }
+
+    Mesh mesh = std::move(meshRes).logError().value();
+    if (token.is_cancelled()) {
+        gfx->destroy_buffer(mesh.vertexBuffer);
+        gfx->destroy_buffer(mesh.indexBuffer);
+        releaseSlot();
+        co_return async::cancelled_error();
+    }
 
     {
         std::lock_guard<std::mutex> lock(storageMutex);
-        meshes.emplace(h, std::move(std::move(meshRes).logError().value()));
+        meshes.emplace(h, std::move(mesh));
     }
+    generation_.fetch_add(1, std::memory_order_release);
 
     co_return h;
 }
@@ -282,6 +360,7 @@ result<void> MeshSystem::removeMesh(MeshHandle handle)
     
     meshes.erase(it);
     freeSlot(handle);
+    generation_.fetch_add(1, std::memory_order_release);
     return {};
 }
 
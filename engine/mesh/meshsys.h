@@ -3,6 +3,7 @@
 #include "imeshsys.h"
 #include "storage/ifstorage.h"
 
+#include <atomic>
 #include <memory>
 #include <bitset>
 #include <string>
@@ -23,7 +24,8 @@ public:
 
     // IMeshSystem interface
     result<MeshHandle> loadMesh(const std::string& path, const MeshImportDesc& desc = {}) override;
-    async::Task<result<MeshHandle>> loadMeshAsync(const std::string& path, const MeshImportDesc& desc = {}) override;
+    async::Task<result<MeshHandle>> loadMeshAsync(const std::string& path, const MeshImportDesc& desc = {},
+                                                  async::CancellationToken token = {}) override;
 
     // Remove mesh
     result<void> removeMesh(MeshHandle handle) override;
@@ -31,6 +33,8 @@ public:
     // Get mesh for rendering
     result<const Mesh*> getMesh(MeshHandle handle) const override;
 
+    uint64_t getGeneration() const override { return generation_.load(std::memory_order_acquire); }
+
 private:
     result<MeshHandle> allocateSlot();
     void freeSlot(MeshHandle handle);
@@ -42,6 +46,7 @@ private:
     std::bitset<MAX_MESH_ENTRIES> slotUsage; // lightweight slot tracking
     mutable std::mutex storageMutex;
     MeshHandle nextHandle = 0;
+    std::atomic<uint64_t> generation_ = 1;
 };
 
 } // namespace jaeng
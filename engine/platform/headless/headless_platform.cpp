@@ -0,0 +1,128 @@
+#include "headless_platform.h"
+#include "common/logging.h"
+#include <atomic>
+#include <csignal>
+#include <filesystem>
+
+#ifdef JAENG_WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <limits.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace jaeng::platform {
+
+// Upper bound on how long the main loop sleeps without mailbox work
+static constexpr int kIdleWaitMs = 100;
+
+static std::atomic<bool> g_quitRequested = false;
+
+static void handle_quit_signal(int) {
+    g_quitRequested.store(true, std::memory_order_relaxed);
+}
+
+HeadlessPlatform::HeadlessPlatform() {
+    auto fm = std::make_shared<FileManager>();
+    fm->set_base_path(get_base_path());
+    fm->set_path_resolver([this](const std::string& path) { return resolve_path(path); });
+    fm->set_exists_func([this](const std::string& path) { return file_exists(path); });
+    fileManager_ = fm;
+
+    g_quitRequested = false;
+    std::signal(SIGINT, handle_quit_signal);
+    std::signal(SIGTERM, handle_quit_signal);
+}
+
+HeadlessPlatform::~HeadlessPlatform() {
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+}
+
+jaeng::result<std::unique_ptr<IWindow>> HeadlessPlatform::create_window(const WindowDesc& desc) {
+    std::unique_ptr<IWindow> window = std::make_unique<HeadlessWindow>(desc);
+    return { std::move(window) };
+}
+
+bool HeadlessPlatform::poll_events() {
+    if (g_quitRequested.load(std::memory_order_relaxed)) {
+        g_quitRequested = false;
+        if (eventCallback_) {
+            Event ev{};
+            ev.type = Event::Type::WindowClose;
+            eventCallback_(ev);
+        }
+    }
+    return true;
+}
+
+void HeadlessPlatform::show_message_box(const std::string& title, const std::string& content, MessageBoxType type) {
+    switch (type) {
+        case MessageBoxType::Error: JAENG_LOG_ERROR("[{}] {}", title, content); break;
+        case MessageBoxType::Warning: JAENG_LOG_WARN("[{}] {}", title, content); break;
+        default: JAENG_LOG_INFO("[{}] {}", title, content); break;
+    }
+}
+
+std::string HeadlessPlatform::get_base_path() const {
+#ifdef JAENG_WIN32
+    char path[MAX_PATH];
+    GetModuleFileNameA(NULL, path, MAX_PATH);
+    std::string pathStr = path;
+    return pathStr.substr(0, pathStr.find_last_of("\\/"));
+#else
+    char result[PATH_MAX];
+    ssize_t count = readlink("/proc/self/exe", result, PATH_MAX);
+    if (count != -1) {
+        std::string path(result, count);
+        return path.substr(0, path.find_last_of("/"));
+    }
+    return ".";
+#endif
+}
+
+std::string HeadlessPlatform::resolve_path(const std::string& path) const {
+    if (!path.empty() && std::filesystem::path(path).is_absolute()) return path;
+    return get_base_path() + "/" + path;
+}
+
+bool HeadlessPlatform::file_exists(const std::string& path) const {
+    return std::filesystem::exists(path);
+}
+
+int HeadlessPlatform::run(std::unique_ptr<IApplication> app) {
+    if (!app->init()) return -1;
+
+    app->start_engine_threads();
+    mainThreadWakeFd_ = app->main_thread_wakeup_fd();
+
+    while (poll_events() && !app->should_close()) {
+        if (app->process_main_thread_tasks()) continue;
+
+        // Nothing queued: sleep until the mailbox is signalled (or a quit signal is due for a check)
+#ifndef JAENG_WIN32
+        if (mainThreadWakeFd_ >= 0) {
+            struct pollfd fd = { mainThreadWakeFd_, POLLIN, 0 };
+            poll(&fd, 1, kIdleWaitMs);
+            continue;
+        }
+#endif
+        jaeng::platform::thread::sleep(1);
+    }
+
+    mainThreadWakeFd_ = -1;
+
+    app->stop_engine_threads();
+    app->shutdown();
+    return 0;
+}
+
+std::unique_ptr<IPlatform> create_headless_platform() {
+    return std::make_unique<HeadlessPlatform>();
+}
+
+} // namespace jaeng::platform
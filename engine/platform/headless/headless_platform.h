@@ -0,0 +1,58 @@
+#pragma once
+
+#include "platform/public/platform_api.h"
+#include "headless_window.h"
+#include "storage/win/filestorage.h"
+#include <memory>
+#include <string>
+
+#ifdef JAENG_WIN32
+#include "platform/win32/win32_process.h"
+#else
+#include "platform/wayland/wayland_process.h"
+#endif
+
+namespace jaeng::platform {
+
+// Platform without a display connection or window system, for simulation servers and CI runs.
+// Windows are HeadlessWindow (no surface), input is always idle and the main loop only services
+// the main-thread mailbox. The app runs with AppConfig::headless forced on, so no swapchain is made.
+// SIGINT/SIGTERM (Ctrl+C / console close on Windows) end the run cleanly.
+class HeadlessPlatform : public IPlatform {
+public:
+    HeadlessPlatform();
+    ~HeadlessPlatform() override;
+
+    jaeng::result<std::unique_ptr<IWindow>> create_window(const WindowDesc& desc) override;
+    IInput& get_input() override { return input_; }
+    bool poll_events() override;
+    void set_event_callback(EventCallback cb) override { eventCallback_ = cb; }
+
+    void show_message_box(const std::string& title, const std::string& content, MessageBoxType type) override;
+    void* get_native_display_handle() const override { return nullptr; }
+
+    IProcessManager& get_process_manager() override { return processManager_; }
+    IFileManager& get_file_manager() override { return *fileManager_; }
+
+    std::string get_base_path() const override;
+    std::string resolve_path(const std::string& path) const override;
+    bool file_exists(const std::string& path) const override;
+    bool is_headless() const override { return true; }
+
+    int run(std::unique_ptr<IApplication> app) override;
+
+private:
+    HeadlessInput input_;
+#ifdef JAENG_WIN32
+    Win32ProcessManager processManager_;
+#else
+    WaylandProcessManager processManager_;
+#endif
+    std::shared_ptr<IFileManager> fileManager_;
+    EventCallback eventCallback_;
+
+    // Main mailbox eventfd of the running app, -1 where unsupported
+    int mainThreadWakeFd_ = -1;
+};
+
+} // namespace jaeng::platform
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "platform/public/platform_api.h"
+
+namespace jaeng::platform {
+
+// Window stand-in for headless runs: has a size, no native surface
+class HeadlessWindow : public IWindow {
+public:
+    explicit HeadlessWindow(const WindowDesc& desc) : width_(desc.width), height_(desc.height) {}
+
+    void destroy() override { open_ = false; }
+    void* get_native_handle() const override { return nullptr; }
+    uint32_t get_width() const override { return width_; }
+    uint32_t get_height() const override { return height_; }
+    bool is_open() const override { return open_; }
+
+private:
+    uint32_t width_ = 0, height_ = 0;
+    bool open_ = true;
+};
+
+class HeadlessInput : public IInput {
+public:
+    bool is_key_down(KeyCode) const override { return false; }
+    MousePos get_mouse_pos() const override { return {0, 0}; }
+};
+
+} // namespace jaeng::platform
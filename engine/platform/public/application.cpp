@@ -1,10 +1,13 @@
 #include "platform/public/platform_api.h"
+#include "platform/headless/headless_window.h"
 #include "material/materialsys.h"
 #include "mesh/meshsys.h"
 #include "texture/texturesys.h"
 #include "ui/fontsys.h"
 #include "common/default_assets.h"
 #include "common/async/awaiters.h"
+#include "render/capture/render_capture.h"
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
@@ -23,23 +26,44 @@ namespace jaeng::platform {
     bool IApplication::init(void* device_handle) {
         JAENG_LOG_INFO("[Engine] init: Setting up scheduler...");
         async::set_current_scheduler(taskScheduler_.get());
+        if (platform_.is_headless()) config_.headless = true;
 
-        JAENG_LOG_INFO("[Engine] init: Creating window...");
-        auto windowResult = platform_.create_window({config_.title, config_.width, config_.height});
-        if (windowResult.hasError()) return false;
-        window_ = std::move(windowResult).logError().value();
+        if (config_.headless) {
+            JAENG_LOG_INFO("[Engine] init: Headless, no window");
+            window_ = std::make_unique<HeadlessWindow>(WindowDesc{config_.title, config_.width, config_.height});
+        } else {
+            JAENG_LOG_INFO("[Engine] init: Creating window...");
+            auto windowResult = platform_.create_window({config_.title, config_.width, config_.height});
+            if (windowResult.hasError()) return false;
+            window_ = std::move(windowResult).logError().value();
+        }
 
         config_.width = window_->get_width();
         config_.height = window_->get_height();
         JAENG_LOG_INFO("[Engine] init: Window created {}x{}", config_.width, config_.height);
         JAENG_LOG_INFO("[Engine] init: Initializing renderer...");
-        if (!renderer_.initialize(config_.backend, window_->get_native_handle(), platform_.get_native_display_handle(), 3, device_handle)) return false;
+        GfxBackend backend = (config_.headless && !config_.headlessRender) ? GfxBackend::Null : config_.backend;
+        if (!renderer_.initialize(backend, window_->get_native_handle(), platform_.get_native_display_handle(), 3, device_handle)) return false;
+
+        if (!config_.renderCapturePath.empty()) {
+            // Wrap the table before anything is created so the capture is self-contained
+            RenderCapture::start(*renderer_.gfx, backend, config_.renderCapturePath, config_.renderCaptureFrames).logError();
+        }
 
-        JAENG_LOG_INFO("[Engine] init: Creating swapchain...");
-        DepthStencilDesc depthDesc{.depth_enable = true, .depth_format = TextureFormat::D32F};
-        SwapchainDesc swapDesc{{window_->get_physical_width(), window_->get_physical_height()}, TextureFormat::BGRA8_UNORM, depthDesc, config_.presentMode};
-        swap_ = renderer_.gfx->create_swapchain(&swapDesc);
-        if (swap_ == 0) return false;
+        if (config_.headless) {
+            JAENG_LOG_INFO("[Engine] init: Creating offscreen targets...");
+            TextureDesc colorDesc{TextureFormat::BGRA8_UNORM, config_.width, config_.height, 1, 1, Access_ColorWrite};
+            TextureDesc depthDesc{TextureFormat::D32F, config_.width, config_.height, 1, 1, Access_DepthWrite};
+            offscreenColor_ = renderer_.gfx->create_texture(&colorDesc, nullptr);
+            offscreenDepth_ = renderer_.gfx->create_texture(&depthDesc, nullptr);
+            if (offscreenColor_ == 0 || offscreenDepth_ == 0) return false;
+        } else {
+            JAENG_LOG_INFO("[Engine] init: Creating swapchain...");
+            DepthStencilDesc depthDesc{.depth_enable = true, .depth_format = TextureFormat::D32F};
+            SwapchainDesc swapDesc{{window_->get_physical_width(), window_->get_physical_height()}, TextureFormat::BGRA8_UNORM, depthDesc, config_.presentMode};
+            swap_ = renderer_.gfx->create_swapchain(&swapDesc);
+            if (swap_ == 0) return false;
+        }
 
         JAENG_LOG_INFO("[Engine] init: Initializing subsystems...");
         auto& fileMan = platform_.get_file_manager();
@@ -56,6 +80,7 @@ namespace jaeng::platform {
         meshSys_ = std::make_shared<MeshSystem>(fileMan, renderer_.gfx);
         texSys_  = std::make_shared<TextureSystem>(std::shared_ptr<IFileManager>(&fileMan, [](IFileManager*){}), renderer_.gfx);
         sceneMan_ = std::make_unique<SceneManager>(meshSys_, matSys_, renderer_.gfx);
+        sceneMan_->setInterpolation(config_.interpolation);
 
         // Register event callback after all subsystems are initialized to avoid crashes on early events
         platform_.set_event_callback([this](const Event& ev) { this->on_event(ev); });
@@ -78,6 +103,7 @@ namespace jaeng::platform {
             config_.height = ev.resize.height;
             if (swap_ > 0 && renderer_.gfx) {
                 renderer_.queue_resize(swap_, window_->get_physical_width(), window_->get_physical_height());
+                request_redraw();
             }
         } else if (ev.type == Event::Type::WindowClose) {
             shouldClose_ = true;
@@ -86,6 +112,7 @@ namespace jaeng::platform {
     }
 
     void IApplication::shutdown() {
+        tickScheduler_.clear(); // Unfinished jobs may reference app state
         app_shutdown(); // Delegate to user app
         
         sceneMan_.reset();
@@ -94,6 +121,12 @@ namespace jaeng::platform {
         matSys_.reset();
         fontSys_.reset();
         entityMan_.reset();
+        if (renderer_.gfx) {
+            if (offscreenColor_) renderer_.gfx->destroy_texture(offscreenColor_);
+            if (offscreenDepth_) renderer_.gfx->destroy_texture(offscreenDepth_);
+            offscreenColor_ = offscreenDepth_ = 0;
+        }
+        RenderCapture::stop();
         renderer_.shutdown();
         if (window_) window_->destroy();
     }
@@ -113,19 +146,32 @@ namespace jaeng::platform {
         config_.presentMode = mode;
         if (swap_ > 0 && renderer_.gfx) {
             renderer_.queue_present_mode(swap_, mode);
+            request_redraw();
+        }
+    }
+
+    void IApplication::request_redraw() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            redrawRequested_ = true;
         }
+        renderCv_.notify_one();
     }
 
     void IApplication::start_engine_threads() {
         if (isRunning_) return;
         isRunning_ = true;
         if (taskScheduler_) {
-            uint32_t workerCount = std::thread::hardware_concurrency();
+            // Workers only get the cores that are not reserved for the sim and render threads
+            auto topology = async::CpuTopology::detect();
+            affinityPlan_ = async::plan_affinity(topology, config_.affinity);
 #if TARGET_OS_SIMULATOR
-            if (workerCount > 4) workerCount = 4;
+            if (affinityPlan_.workers.size() > 4) affinityPlan_.workers.resize(4);
 #endif
-            taskScheduler_->initialize(workerCount);
-            JAENG_LOG_INFO("[Engine] Starting engine loops via std::thread ({} workers)", workerCount);
+            taskScheduler_->initialize(affinityPlan_);
+            taskScheduler_->set_stats_dump_interval(std::chrono::milliseconds(config_.schedulerStatsIntervalMs));
+            JAENG_LOG_INFO("[Engine] Starting engine loops via std::thread ({} workers, {}, pinned: {})",
+                           affinityPlan_.worker_count(), topology.describe(), affinityPlan_.pinned);
         } else {
             JAENG_LOG_INFO("[Engine] Starting engine loops via std::thread (no scheduler)");
         }
@@ -138,12 +184,17 @@ namespace jaeng::platform {
         isRunning_ = false;
         async::set_current_scheduler(nullptr);
         if (taskScheduler_) {
+            if (config_.schedulerStatsIntervalMs > 0) taskScheduler_->dump_stats();
             taskScheduler_->shutdown();
         }
         renderCv_.notify_all(); // Wake up render thread if it's waiting
 
         if (simThread_.joinable()) simThread_.join();
         if (renderThread_.joinable()) renderThread_.join();
+
+        if (simPacer_.stats().waits > 0) {
+            JAENG_LOG_INFO("[Engine] Sim pacing: {}", simPacer_.stats().format());
+        }
     }
 
     bool IApplication::process_main_thread_tasks() {
@@ -154,33 +205,79 @@ namespace jaeng::platform {
         return platform_.get_file_manager();
     }
 
+    void IApplication::run_tick_jobs() {
+        auto budget = std::chrono::duration<float, std::milli>(config_.tickJobBudgetMs);
+        tickScheduler_.run_tick(std::chrono::duration_cast<std::chrono::microseconds>(budget));
+    }
+
+    bool IApplication::publish_render_state() {
+        auto& stream = stateBuffer_.get_producer();
+
+        // Extraction emits deltas, so a stream is only published once the render thread took the
+        // previous one. Until then frames keep appending to it; if the render thread stalls long
+        // enough for it to grow too large, drop it and have extraction send a snapshot instead.
+        if (!producerPending_) {
+            stream.clear();
+        } else if (stream.byteSize() > kMaxPendingStreamBytes) {
+            stream.discard();
+        }
+
+        stream.beginFrame(++renderSequence_, simTime_);
+        extract_render_state(stream);
+        producerPending_ = !stateBuffer_.try_push_producer();
+        return !producerPending_;
+    }
+
+    void IApplication::signal_frame_ready() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            frameReady_ = true;
+        }
+        renderCv_.notify_one();
+    }
+
     void IApplication::run_one_frame() {
         tick(fixedDt_);
+        run_tick_jobs();
+        simTime_ += fixedDt_;
         JAENG_LOG_DEBUG("[Engine] run_one_frame executed");
-        auto& producerQueue = stateBuffer_.get_producer();
-        extract_render_state(producerQueue);
-        stateBuffer_.push_producer();
+        publish_render_state();
         stateBuffer_.update_consumer();
         
         renderer_.process_pending_resizes();
-        if (renderer_->begin_frame()) {
-            TextureHandle backbuffer = renderer_->get_current_backbuffer(swap_);
-            TextureHandle depthbuffer = renderer_->get_depth_buffer(swap_);
-            RenderGraph graph;
-            render(stateBuffer_.get_consumer(), true, graph, backbuffer, depthbuffer);
-            graph.compile();
-            graph.execute(*renderer_.gfx, depthbuffer, nullptr);
-            renderer_->present(swap_);
-            renderer_->end_frame();
-        }
+        draw_frame(true);
+    }
+
+    void IApplication::draw_frame(bool hasNewState) {
+        if (!renderer_->begin_frame()) return;
+
+        TextureHandle backbuffer = swap_ ? renderer_->get_current_backbuffer(swap_) : offscreenColor_;
+        TextureHandle depthbuffer = swap_ ? renderer_->get_depth_buffer(swap_) : offscreenDepth_;
+
+        RenderGraph graph;
+
+        // Render the extracted state
+        render(stateBuffer_.get_consumer(), hasNewState, graph, backbuffer, depthbuffer);
+
+        graph.compile();
+        graph.execute(*renderer_.gfx, depthbuffer, nullptr);
+        if (swap_) renderer_->present(swap_);
+        renderer_->end_frame();
     }
 
     void IApplication::simulation_loop() {
 #ifdef JAENG_APPLE
         async::set_current_scheduler(taskScheduler_.get());
 #endif
+        if (!async::set_current_thread_affinity(affinityPlan_.simulation)) {
+            JAENG_LOG_WARN("[Engine] Failed to pin the simulation thread");
+        }
 
-        auto lastTime = std::chrono::high_resolution_clock::now();
+        simPacer_.set_spin_threshold(std::chrono::microseconds(config_.simSpinUs));
+        simPacer_.reset_stats();
+
+        // steady_clock, so deadlines handed to the pacer are on the same (monotonic) clock
+        auto lastTime = async::FramePacer::Clock::now();
         float accumulator = 0.0f;
         JAENG_LOG_INFO("[Engine] Simulation loop started");
 
@@ -189,7 +286,7 @@ namespace jaeng::platform {
             auto* pool = NS::AutoreleasePool::alloc()->init();
 #endif
 
-            auto now = std::chrono::high_resolution_clock::now();
+            auto now = async::FramePacer::Clock::now();
             float dt = std::chrono::duration<float>(now - lastTime).count();
             lastTime = now;
 
@@ -201,26 +298,28 @@ namespace jaeng::platform {
             // Run deterministic simulation steps
             while (accumulator >= fixedDt_) {
                 tick(fixedDt_);
+                run_tick_jobs();
+                simTime_ += fixedDt_;
                 accumulator -= fixedDt_;
                 stateChanged = true;
             }
 
             // If the state changed, extract it and hand it off to the render thread
             if (stateChanged) {
-                auto& producerQueue = stateBuffer_.get_producer();
-
-                extract_render_state(producerQueue);
-                stateBuffer_.push_producer();
-
-                {
-                    std::lock_guard<std::mutex> lock(stateMutex_);
-                    frameReady_ = true;
-                }
-                renderCv_.notify_one();
+                if (publish_render_state()) signal_frame_ready();
+            }
+            else if (producerPending_ && stateBuffer_.try_push_producer()) {
+                // The render thread caught up, hand over what accumulated meanwhile
+                producerPending_ = false;
+                signal_frame_ready();
             }
             else {
-                // Prevent aggressive spinning on some platforms (like iOS Simulator)
-                jaeng::platform::thread::yield();
+                // Nothing to do until the next tick: sleep until it is due instead of spinning. While a
+                // stream waits for the render thread, wake up sooner to hand it over.
+                auto untilTick = std::chrono::duration<float>(fixedDt_ - accumulator);
+                auto deadline = now + std::chrono::duration_cast<async::FramePacer::Clock::duration>(untilTick);
+                if (producerPending_) deadline = std::min(deadline, now + kPendingPollInterval);
+                simPacer_.wait_until(deadline);
             }
 
 #ifdef JAENG_APPLE
@@ -235,22 +334,55 @@ namespace jaeng::platform {
 #ifdef JAENG_APPLE
         async::set_current_scheduler(taskScheduler_.get());
 #endif
+        if (!async::set_current_thread_affinity(affinityPlan_.render)) {
+            JAENG_LOG_WARN("[Engine] Failed to pin the render thread");
+        }
+
+        using Clock = async::FramePacer::Clock;
+        const auto frameInterval = config_.targetFps > 0
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config_.targetFps))
+            : Clock::duration::zero();
+        auto nextFrame = Clock::now();
+        const bool lowLatency = config_.lowLatencyRender && !config_.interpolation && config_.presentMode != PresentMode::Fifo;
 
         JAENG_LOG_INFO("[Engine] Render loop started");
         while (isRunning_) {
             // Wait for the simulation thread to produce a new frame packet ONLY IF we are in V-Sync mode.
             // In Mailbox or Immediate modes, we want to spin as fast as possible to minimize latency.
-            if (config_.presentMode == PresentMode::Fifo) {
+            // With interpolation every vblank shows a new blend, so there is nothing to wait for either.
+            if (config_.presentMode == PresentMode::Fifo && !config_.interpolation) {
+                std::unique_lock<std::mutex> lock(stateMutex_);
+                renderCv_.wait(lock, [this]() { return frameReady_.load() || redrawRequested_.load() || !isRunning_; });
+                frameReady_ = false;
+            } else if (lowLatency) {
+                // Sleep until new sim state arrives or the frame deadline passes, whichever comes first
+                auto deadline = frameInterval > Clock::duration::zero() ? nextFrame : Clock::now() + kIdleRedrawInterval;
                 std::unique_lock<std::mutex> lock(stateMutex_);
-                renderCv_.wait(lock, [this]() { return frameReady_.load() || !isRunning_; });
+                renderCv_.wait_until(lock, deadline, [this]() { return frameReady_.load() || redrawRequested_.load() || !isRunning_; });
                 frameReady_ = false;
+            } else if (config_.skipIdenticalFrames && !config_.interpolation) {
+                // Sleep until there is something new to show, then keep to the targetFps cadence
+                {
+                    std::unique_lock<std::mutex> lock(stateMutex_);
+                    renderCv_.wait_until(lock, Clock::now() + kIdleRedrawInterval, [this]() { return frameReady_.load() || redrawRequested_.load() || !isRunning_; });
+                    frameReady_ = false;
+                }
+                if (isRunning_ && frameInterval > Clock::duration::zero()) renderPacer_.wait_until(nextFrame);
             } else {
+                if (frameInterval > Clock::duration::zero()) renderPacer_.wait_until(nextFrame);
                 // Still need to reset the flag if it was set, though less critical in uncapped mode
                 frameReady_.store(false, std::memory_order_relaxed);
             }
 
             if (!isRunning_) break;
 
+            if (frameInterval > Clock::duration::zero() && !lowLatency) {
+                // Keep the cadence, but don't try to catch up on frames missed by more than one interval
+                auto now = Clock::now();
+                nextFrame += frameInterval;
+                if (nextFrame < now) nextFrame = now + frameInterval;
+            }
+
 #ifdef JAENG_APPLE
             auto* pool = NS::AutoreleasePool::alloc()->init();
 #endif
@@ -262,26 +394,21 @@ namespace jaeng::platform {
                 bool hasNewState = stateBuffer_.update_consumer();
 
                 // Engine strictly owns the resize, compile, and present steps!
-                renderer_.process_pending_resizes();
-                if (renderer_->begin_frame()) {
-                    TextureHandle backbuffer = renderer_->get_current_backbuffer(swap_);
-                    TextureHandle depthbuffer = renderer_->get_depth_buffer(swap_);
-
-                    RenderGraph graph;
+                bool swapchainChanged = renderer_.process_pending_resizes();
+                bool redraw = redrawRequested_.exchange(false) || swapchainChanged;
 
-                    // Render the extracted state
-                    render(stateBuffer_.get_consumer(), hasNewState, graph, backbuffer, depthbuffer);
-
-                    graph.compile();
-                    graph.execute(*renderer_.gfx, depthbuffer, nullptr);
-                    renderer_->present(swap_);
-                    renderer_->end_frame();
-                }
+                // The previous frame already shows this state
+                bool skip = config_.skipIdenticalFrames && !config_.interpolation && !hasNewState && !redraw;
+                if (!skip) draw_frame(hasNewState);
             } else {
                 // Throttle while in background
                 jaeng::platform::thread::sleep_idle();
             }
 
+            // Low latency frames render as soon as state arrives, the deadline only bounds the wait
+            // after the last one
+            if (lowLatency && frameInterval > Clock::duration::zero()) nextFrame = Clock::now() + frameInterval;
+
 #ifdef JAENG_APPLE
             pool->release();
 #endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
@@ -16,12 +17,14 @@
 #include "texture/itexturesys.h"
 #include "render/frontend/renderer.h"
 #include "render/graph/render_graph.h"
-#include "scene/ipartition.h"
+#include "scene/render_commands.h"
 #include "scene/scene.h"
 #include "storage/ifstorage.h"
 #include "ui/fontsys.h"
 #include "process.h"
+#include "common/async/frame_pacer.h"
 #include "common/async/task_scheduler.h"
+#include "common/async/tick_scheduler.h"
 
 namespace jaeng {
 
@@ -113,6 +116,35 @@ struct AppConfig {
     InputMode inputMode = InputMode::Mouse;
     renderer::PresentMode presentMode = renderer::PresentMode::Fifo;
     bool vSync = true;
+    // Worker count and core pinning for the sim, render, compute and IO threads
+    async::AffinityConfig affinity;
+    // Logs TaskScheduler queue/latency/utilization stats at this interval, 0 disables
+    uint32_t schedulerStatsIntervalMs = 0;
+    // CPU time per fixed step handed to time-sliced jobs (IApplication::tickScheduler)
+    float tickJobBudgetMs = 2.0f;
+    // The sim thread sleeps until the next tick is due and only spins for this last stretch
+    uint32_t simSpinUs = 500;
+    // Render loop limits for Mailbox/Immediate modes (and Fifo with interpolation).
+    // targetFps caps the frame rate, 0 leaves it uncapped.
+    uint32_t targetFps = 0;
+    // Don't re-render when no new sim state arrived and nothing requested a redraw (ignored while interpolating).
+    // Frames with new state still keep to the targetFps cap.
+    bool skipIdenticalFrames = false;
+    // Instead of rendering on a fixed cadence, wait for new sim state and render it right away; the
+    // targetFps interval after the last frame (or kIdleRedrawInterval when uncapped) bounds the wait
+    bool lowLatencyRender = false;
+    // Render thread blends transforms between the last two sim snapshots, so the frame rate can exceed
+    // the tick rate without stutter. Adds one tick of latency; Fifo no longer waits for new sim frames.
+    bool interpolation = false;
+    // No window surface, swapchain or present (forced on by HeadlessPlatform). Without headlessRender
+    // the Null backend is used, so sim, extraction and render graph building run but nothing is drawn;
+    // with it the configured backend renders each frame into offscreen targets of width x height.
+    bool headless = false;
+    bool headlessRender = false;
+    // Records every RendererAPI call to this file for offline replay (tools/render_replay), empty disables.
+    // Capture stops after renderCaptureFrames frames, 0 records until shutdown.
+    std::string renderCapturePath;
+    uint32_t renderCaptureFrames = 0;
 };
 
 class IPlatform;
@@ -134,7 +166,15 @@ public:
     void stop_engine_threads();
     void run_one_frame();
     bool process_main_thread_tasks();
+    // See TaskScheduler::main_thread_wakeup_fd
+    int main_thread_wakeup_fd() const { return taskScheduler_ ? taskScheduler_->main_thread_wakeup_fd() : -1; }
     async::TaskScheduler& taskScheduler() { return *taskScheduler_; }
+    // Coroutine jobs resumed on the sim thread after each tick, within AppConfig::tickJobBudgetMs
+    async::TickScheduler& tickScheduler() { return tickScheduler_; }
+    // Paces the sim thread between ticks; its stats are the tick wakeup jitter
+    const async::FramePacer& simPacer() const { return simPacer_; }
+    // Forces the next render loop iteration to draw, even when skipping identical frames
+    void request_redraw();
     void set_platform_drawable(void* drawable) { if (renderer_.gfx && renderer_.gfx->set_platform_drawable) renderer_.gfx->set_platform_drawable(drawable); }
 
     IPlatform& platform() { return platform_; }
@@ -151,12 +191,13 @@ protected:
     virtual void tick(float dt) = 0;
 
     // Extraction Phase (Sim Thread -> Render Thread sync point)
-    // Copies necessary data from ECS into a Render Packet
-    virtual void extract_render_state(std::vector<RenderCommand>& outQueue) = 0;
+    // Appends the changes since the last extraction to the stream. Do not clear it: it may still
+    // hold commands of earlier frames the render thread skipped.
+    virtual void extract_render_state(RenderCommandStream& outQueue) = 0;
 
     // Render Phase (Render Thread)
     // Consumes the Render Packet and dispatches to the GPU
-    virtual void render(const std::vector<RenderCommand>& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) = 0;
+    virtual void render(const RenderCommandStream& inQueue, bool hasNewState, RenderGraph& graph, TextureHandle backbuffer, TextureHandle depthbuffer) = 0;
 
     // Engine System Accessors for user app
     IFileManager& fileManager();
@@ -168,31 +209,49 @@ protected:
     SceneManager& sceneManager() { return *sceneMan_; }
     RendererAPI& renderer() { return *renderer_.gfx; }
     IWindow& window() { return *window_; }
+    bool is_headless() const { return config_.headless; }
 
 private:
     void simulation_loop();
     void render_loop();
+    void run_tick_jobs();
+    bool publish_render_state(); // Returns true if a new stream was handed to the render thread
+    void signal_frame_ready();
+    void draw_frame(bool hasNewState);
 
     std::unique_ptr<async::TaskScheduler> taskScheduler_;
+    async::TickScheduler tickScheduler_;
+    async::FramePacer simPacer_;
+    async::FramePacer renderPacer_;
     std::thread simThread_;
     std::thread renderThread_;
     std::atomic<bool> isRunning_ = false;
+    async::AffinityPlan affinityPlan_;
 
     float fixedDt_ = 1.0f / 60.0f;
+    double simTime_ = 0.0;  // Simulated seconds, advanced by fixedDt_ per tick
 
     // Synchronization primitives for the frame swap
     std::mutex stateMutex_;
     std::condition_variable renderCv_;
     std::atomic<bool> frameReady_ = false;
-
-    // Triple buffer for passing render commands from Sim to Render thread without blocking
-    TripleBuffer<std::vector<RenderCommand>> stateBuffer_;
+    std::atomic<bool> redrawRequested_ = true;  // First frame always draws
+
+    // Triple buffer for passing render command streams from Sim to Render thread without blocking
+    TripleBuffer<RenderCommandStream> stateBuffer_;
+    bool producerPending_ = false;  // Producer stream is filled but not published yet
+    uint64_t renderSequence_ = 0;
+    static constexpr size_t kMaxPendingStreamBytes = 8 * 1024 * 1024;
+    static constexpr std::chrono::microseconds kPendingPollInterval{250};
+    static constexpr std::chrono::milliseconds kIdleRedrawInterval{100};
     
     // Engine Core State and Systems
     IPlatform& platform_;
     std::unique_ptr<IWindow> window_;
     Renderer renderer_;
     SwapchainHandle swap_ = 0;
+    TextureHandle offscreenColor_ = 0;  // Headless render targets, used instead of the swapchain
+    TextureHandle offscreenDepth_ = 0;
     AppConfig config_;
     bool shouldClose_ = false;
     
@@ -224,6 +283,8 @@ public:
     virtual std::string resolve_path(const std::string& path) const = 0;
     virtual bool file_exists(const std::string& path) const = 0;
     virtual bool is_foreground() const { return true; }
+    // No display or window system; apps run with AppConfig::headless
+    virtual bool is_headless() const { return false; }
 
     // The entry point abstraction: takes application and enters the loop
     virtual int run(std::unique_ptr<IApplication> app) = 0;
@@ -231,6 +292,8 @@ public:
 
 // Factory function
 std::unique_ptr<IPlatform> create_platform(void* context = nullptr);
+// Display-less platform for servers and CI (Windows and Linux only)
+std::unique_ptr<IPlatform> create_headless_platform();
 
 // Platform-aware threading utilities
 namespace thread {
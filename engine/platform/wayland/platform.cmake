@@ -55,7 +55,11 @@ list(APPEND JAENG_SOURCES
   platform/wayland/wayland_input.cpp
   platform/wayland/wayland_process.h
   platform/wayland/wayland_process.cpp
+  platform/headless/headless_platform.h
+  platform/headless/headless_platform.cpp
   storage/win/filestorage.cpp
+  storage/linux/uring_loader.h
+  storage/linux/uring_loader.cpp
   "${XDG_SHELL_CLIENT_HEADER}"
   "${XDG_DECORATION_CLIENT_HEADER}"
 )
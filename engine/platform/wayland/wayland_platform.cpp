@@ -17,6 +17,9 @@ namespace jaeng::platform {
 
 WaylandPlatform* WaylandPlatform::instance_ = nullptr;
 
+// Upper bound on how long poll_events sleeps without input or mailbox work
+static constexpr int kIdleWaitMs = 100;
+
 WaylandPlatform::WaylandPlatform() {
     instance_ = this;
     auto fm = std::make_shared<FileManager>();
@@ -95,12 +98,16 @@ bool WaylandPlatform::poll_events() {
     if (wl_display_prepare_read(display_) == 0) {
         wl_display_flush(display_);
 
+        // With a mailbox fd to wake on, block until there is input or main-thread work instead of spinning
         struct pollfd fds[] = {
             { wl_display_get_fd(display_), POLLIN, 0 },
+            { mainThreadWakeFd_, POLLIN, 0 },
         };
+        nfds_t count = mainThreadWakeFd_ >= 0 ? 2 : 1;
+        int timeout = mainThreadWakeFd_ >= 0 ? kIdleWaitMs : 0;
 
-        int ret = poll(fds, 1, 0);
-        if (ret > 0) {
+        int ret = poll(fds, count, timeout);
+        if (ret > 0 && (fds[0].revents & POLLIN)) {
             wl_display_read_events(display_);
         } else {
             wl_display_cancel_read(display_);
@@ -141,11 +148,14 @@ int WaylandPlatform::run(std::unique_ptr<IApplication> app) {
     if (!app->init()) return -1;
 
     app->start_engine_threads();
+    mainThreadWakeFd_ = app->main_thread_wakeup_fd();
 
     while (poll_events() && !app->should_close()) {
         app->process_main_thread_tasks();
     }
 
+    mainThreadWakeFd_ = -1;
+
     app->stop_engine_threads();
     app->shutdown();
     return 0;
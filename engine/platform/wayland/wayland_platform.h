@@ -60,6 +60,8 @@ private:
     EventCallback eventCallback_;
 
     bool running_ = true;
+    // Main mailbox eventfd of the running app; poll_events sleeps on it alongside the display fd
+    int mainThreadWakeFd_ = -1;
 
     static WaylandPlatform* instance_;
     friend class WaylandWindow;
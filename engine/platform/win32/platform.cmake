@@ -5,6 +5,8 @@ list(APPEND JAENG_SOURCES
   platform/win32/win32_platform.cpp
   platform/win32/win32_process.h
   platform/win32/win32_process.cpp
+  platform/headless/headless_platform.h
+  platform/headless/headless_platform.cpp
   storage/win/filestorage.cpp
   storage/win/filestorage.h
 )
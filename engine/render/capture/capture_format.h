@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// On-disk layout shared by the RendererAPI capture layer and the replay tool.
+//
+// File:   FileHeader, then records until EOF.
+// Record: RecordHeader followed by `size` payload bytes. Payloads are the call arguments in
+//         declaration order, raw and little-endian as in memory; descriptor structs are stored
+//         whole, pointed-to data follows as a byte count plus bytes. Calls that return a handle
+//         append it last, so replay can map captured handles to its own.
+
+namespace jaeng::renderer::capture {
+
+constexpr uint32_t kMagic = 0x3143524A; // "JRC1"
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t backend;  // GfxBackend the capture was taken on
+    uint32_t reserved;
+};
+
+enum class Op : uint16_t {
+    BeginFrame, EndFrame,
+    CreateSwapchain, ResizeSwapchain, SetPresentMode, DestroySwapchain, GetBackbuffer, GetDepthBuffer,
+    CreateBuffer, DestroyBuffer, UpdateBuffer,
+    CreateTexture, DestroyTexture, CreateSampler, DestroySampler, GetTextureIndex, GetSamplerIndex,
+    CreateShaderModule, DestroyShaderModule, CreateVertexLayout, DestroyVertexLayout,
+    CreatePipeline, DestroyPipeline,
+    BeginCommands, BeginPass, EndPass, BindUniform, PushConstants, Barrier,
+    SetPipeline, SetVertexBuffer, SetIndexBuffer, SetScissor, Draw, DrawIndexed, EndCommands,
+    Submit, Present, WaitIdle,
+    Count
+};
+
+struct RecordHeader {
+    Op op;
+    uint16_t reserved;
+    uint32_t size;
+};
+static_assert(sizeof(RecordHeader) == 8);
+
+// Appends trivially copyable values and byte blobs to a record payload
+class PayloadWriter {
+public:
+    explicit PayloadWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    template<typename T>
+    PayloadWriter& put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return bytes(&value, sizeof(T));
+    }
+
+    PayloadWriter& bytes(const void* data, size_t size) {
+        if (size == 0) return *this;
+        size_t at = out_.size();
+        out_.resize(at + size);
+        std::memcpy(out_.data() + at, data, size);
+        return *this;
+    }
+
+    // Length-prefixed blob; a null pointer is stored as an empty blob
+    PayloadWriter& blob(const void* data, uint64_t size) {
+        if (!data) size = 0;
+        put(size);
+        return bytes(data, static_cast<size_t>(size));
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+// Reads a payload back in the order it was written. Reads past the end yield zeroes and set failed().
+class PayloadReader {
+public:
+    PayloadReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    template<typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        if (pos_ + sizeof(T) > size_) {
+            failed_ = true;
+            return value;
+        }
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    // Returns a pointer into the payload (nullptr for an empty blob) and its size
+    const uint8_t* blob(uint64_t& size) {
+        size = get<uint64_t>();
+        if (size == 0 || pos_ + size > size_) {
+            if (size != 0) failed_ = true;
+            size = 0;
+            return nullptr;
+        }
+        const uint8_t* p = data_ + pos_;
+        pos_ += static_cast<size_t>(size);
+        return p;
+    }
+
+    bool failed() const { return failed_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+} // namespace jaeng::renderer::capture
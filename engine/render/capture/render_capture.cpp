@@ -0,0 +1,373 @@
+#include "render_capture.h"
+#include "capture_format.h"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#include "common/logging.h"
+
+namespace jaeng::renderer {
+
+using namespace capture;
+
+namespace {
+
+constexpr size_t kFlushBytes = 4 * 1024 * 1024;
+
+RendererAPI g_inner{};              // The backend being captured
+std::mutex g_mutex;                 // Guards the file and pending bytes
+std::FILE* g_file = nullptr;
+std::vector<uint8_t> g_pending;
+std::atomic<bool> g_recording = false;
+std::atomic<uint64_t> g_frames = 0;
+uint32_t g_maxFrames = 0;
+
+void flush_locked() {
+    if (g_file && !g_pending.empty()) {
+        std::fwrite(g_pending.data(), 1, g_pending.size(), g_file);
+    }
+    g_pending.clear();
+}
+
+void close_locked() {
+    g_recording.store(false, std::memory_order_release);
+    flush_locked();
+    if (g_file) {
+        std::fclose(g_file);
+        g_file = nullptr;
+        JAENG_LOG_INFO("[RenderCapture] Stopped after {} frames", g_frames.load());
+    }
+}
+
+// Serializes one call. fill writes the payload; it only runs while recording.
+template<typename Fill>
+void record(Op op, Fill&& fill) {
+    if (!g_recording.load(std::memory_order_acquire)) return;
+
+    thread_local std::vector<uint8_t> payload;
+    payload.clear();
+    PayloadWriter writer(payload);
+    fill(writer);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_file) return;
+    RecordHeader header{ op, 0, static_cast<uint32_t>(payload.size()) };
+    PayloadWriter(g_pending).put(header).bytes(payload.data(), payload.size());
+    if (g_pending.size() >= kFlushBytes) flush_locked();
+}
+
+void record(Op op) {
+    record(op, [](PayloadWriter&) {});
+}
+
+uint64_t texture_bytes(const TextureDesc& desc) {
+    // Every supported format is 4 bytes per texel, mips are not uploaded
+    return uint64_t(desc.width) * desc.height * 4 * (desc.layers ? desc.layers : 1);
+}
+
+// --- Recording entries ---
+bool cap_begin_frame() {
+    bool ok = g_inner.begin_frame();
+    record(Op::BeginFrame, [&](PayloadWriter& w) { w.put(ok); });
+    return ok;
+}
+
+void cap_end_frame() {
+    record(Op::EndFrame);
+    g_inner.end_frame();
+
+    if (g_recording.load(std::memory_order_acquire)) {
+        uint64_t frames = g_frames.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (g_maxFrames > 0 && frames >= g_maxFrames) RenderCapture::stop();
+    }
+}
+
+SwapchainHandle cap_create_swapchain(const SwapchainDesc* desc) {
+    SwapchainHandle h = g_inner.create_swapchain(desc);
+    record(Op::CreateSwapchain, [&](PayloadWriter& w) { w.put(*desc).put(h); });
+    return h;
+}
+
+void cap_resize_swapchain(SwapchainHandle h, Extent2D size) {
+    record(Op::ResizeSwapchain, [&](PayloadWriter& w) { w.put(h).put(size); });
+    g_inner.resize_swapchain(h, size);
+}
+
+void cap_set_present_mode(SwapchainHandle h, PresentMode mode) {
+    record(Op::SetPresentMode, [&](PayloadWriter& w) { w.put(h).put(mode); });
+    g_inner.set_present_mode(h, mode);
+}
+
+void cap_destroy_swapchain(SwapchainHandle h) {
+    record(Op::DestroySwapchain, [&](PayloadWriter& w) { w.put(h); });
+    g_inner.destroy_swapchain(h);
+}
+
+TextureHandle cap_get_current_backbuffer(SwapchainHandle h) {
+    TextureHandle t = g_inner.get_current_backbuffer(h);
+    record(Op::GetBackbuffer, [&](PayloadWriter& w) { w.put(h).put(t); });
+    return t;
+}
+
+TextureHandle cap_get_depth_buffer(SwapchainHandle h) {
+    TextureHandle t = g_inner.get_depth_buffer(h);
+    record(Op::GetDepthBuffer, [&](PayloadWriter& w) { w.put(h).put(t); });
+    return t;
+}
+
+BufferHandle cap_create_buffer(const BufferDesc* desc, const void* initial_data) {
+    BufferHandle h = g_inner.create_buffer(desc, initial_data);
+    record(Op::CreateBuffer, [&](PayloadWriter& w) { w.put(*desc).blob(initial_data, desc->size_bytes).put(h); });
+    return h;
+}
+
+void cap_destroy_buffer(BufferHandle h) {
+    record(Op::DestroyBuffer, [&](PayloadWriter& w) { w.put(h); });
+    g_inner.destroy_buffer(h);
+}
+
+bool cap_update_buffer(BufferHandle h, uint64_t dst_offset, const void* data, uint64_t size) {
+    record(Op::UpdateBuffer, [&](PayloadWriter& w) { w.put(h).put(dst_offset).blob(data, size); });
+    return g_inner.update_buffer(h, dst_offset, data, size);
+}
+
+TextureHandle cap_create_texture(const TextureDesc* desc, const void* initial_data) {
+    TextureHandle h = g_inner.create_texture(desc, initial_data);
+    record(Op::CreateTexture, [&](PayloadWriter& w) { w.put(*desc).blob(initial_data, texture_bytes(*desc)).put(h); });
+    return h;
+}
+
+void cap_destroy_texture(TextureHandle h) {
+    record(Op::DestroyTexture, [&](PayloadWriter& w) { w.put(h); });
+    g_inner.destroy_texture(h);
+}
+
+SamplerHandle cap_create_sampler(const SamplerDesc* desc) {
+    SamplerHandle h = g_inner.create_sampler(desc);
+    record(Op::CreateSampler, [&](PayloadWriter& w) { w.put(*desc).put(h); });
+    return h;
+}
+
+void cap_destroy_sampler(SamplerHandle h) {
+    record(Op::DestroySampler, [&](PayloadWriter& w) { w.put(h); });
+    g_inner.destroy_sampler(h);
+}
+
+uint32_t cap_get_texture_index(TextureHandle h) {
+    uint32_t index = g_inner.get_texture_index(h);
+    record(Op::GetTextureIndex, [&](PayloadWriter& w) { w.put(h).put(index); });
+    return index;
+}
+
+uint32_t cap_get_sampler_index(SamplerHandle h) {
+    uint32_t index = g_inner.get_sampler_index(h);
+    record(Op::GetSamplerIndex, [&](PayloadWriter& w) { w.put(h).put(index); });
+    return index;
+}
+
+ShaderModuleHandle cap_create_shader_module(const ShaderModuleDesc* desc) {
+    ShaderModuleHandle h = g_inner.create_shader_module(desc);
+    record(Op::CreateShaderModule, [&](PayloadWriter& w) {
+        w.put(desc->stage).put(desc->format).blob(desc->data, desc->size).put(h);
+    });
+    return h;
+}
+
+void cap_destroy_shader_module(ShaderModuleHandle h) {
+    record(Op::DestroyShaderModule, [&](PayloadWriter& w) { w.put(h); });
+    g_inner.destroy_shader_module(h);
+}
+
+VertexLayoutHandle cap_create_vertex_layout(const VertexLayoutDesc* desc) {
+    VertexLayoutHandle h = g_inner.create_vertex_layout(desc);
+    record(Op::CreateVertexLayout, [&](PayloadWriter& w) {
+        w.put(desc->stride).blob(desc->attributes, uint64_t(desc->attribute_count) * sizeof(VertexAttributeDesc)).put(h);
+    });
+    return h;
+}
+
+void cap_destroy_vertex_layout(VertexLayoutHandle h) {
+    record(Op::DestroyVertexLayout, [&](PayloadWriter& w) { w.put(h); });
+    g_inner.destroy_vertex_layout(h);
+}
+
+PipelineHandle cap_create_graphics_pipeline(const GraphicsPipelineDesc* desc) {
+    PipelineHandle h = g_inner.create_graphics_pipeline(desc);
+    record(Op::CreatePipeline, [&](PayloadWriter& w) { w.put(*desc).put(h); });
+    return h;
+}
+
+void cap_destroy_pipeline(PipelineHandle h) {
+    record(Op::DestroyPipeline, [&](PayloadWriter& w) { w.put(h); });
+    g_inner.destroy_pipeline(h);
+}
+
+CommandListHandle cap_begin_commands() {
+    CommandListHandle h = g_inner.begin_commands();
+    record(Op::BeginCommands, [&](PayloadWriter& w) { w.put(h); });
+    return h;
+}
+
+void cap_cmd_begin_pass(CommandListHandle cmd, LoadOp load_op, const ColorAttachmentDesc* colors, uint32_t count, const DepthAttachmentDesc* depth) {
+    record(Op::BeginPass, [&](PayloadWriter& w) {
+        w.put(cmd).put(load_op).blob(colors, uint64_t(count) * sizeof(ColorAttachmentDesc)).put(depth != nullptr);
+        if (depth) w.put(*depth);
+    });
+    g_inner.cmd_begin_pass(cmd, load_op, colors, count, depth);
+}
+
+void cap_cmd_end_pass(CommandListHandle cmd) {
+    record(Op::EndPass, [&](PayloadWriter& w) { w.put(cmd); });
+    g_inner.cmd_end_pass(cmd);
+}
+
+void cap_cmd_bind_uniform(CommandListHandle cmd, uint32_t slot, BufferHandle h, uint64_t offset) {
+    record(Op::BindUniform, [&](PayloadWriter& w) { w.put(cmd).put(slot).put(h).put(offset); });
+    g_inner.cmd_bind_uniform(cmd, slot, h, offset);
+}
+
+void cap_cmd_push_constants(CommandListHandle cmd, uint32_t offset, uint32_t count, const void* data) {
+    // count is in 32-bit values
+    record(Op::PushConstants, [&](PayloadWriter& w) { w.put(cmd).put(offset).blob(data, uint64_t(count) * 4); });
+    g_inner.cmd_push_constants(cmd, offset, count, data);
+}
+
+void cap_cmd_barrier(CommandListHandle cmd, BufferHandle h, uint32_t src_access, uint32_t dst_access) {
+    record(Op::Barrier, [&](PayloadWriter& w) { w.put(cmd).put(h).put(src_access).put(dst_access); });
+    g_inner.cmd_barrier(cmd, h, src_access, dst_access);
+}
+
+void cap_cmd_set_pipeline(CommandListHandle cmd, PipelineHandle h) {
+    record(Op::SetPipeline, [&](PayloadWriter& w) { w.put(cmd).put(h); });
+    g_inner.cmd_set_pipeline(cmd, h);
+}
+
+void cap_cmd_set_vertex_buffer(CommandListHandle cmd, uint32_t slot, BufferHandle h, uint64_t offset) {
+    record(Op::SetVertexBuffer, [&](PayloadWriter& w) { w.put(cmd).put(slot).put(h).put(offset); });
+    g_inner.cmd_set_vertex_buffer(cmd, slot, h, offset);
+}
+
+void cap_cmd_set_index_buffer(CommandListHandle cmd, BufferHandle h, bool index32, uint64_t offset) {
+    record(Op::SetIndexBuffer, [&](PayloadWriter& w) { w.put(cmd).put(h).put(index32).put(offset); });
+    g_inner.cmd_set_index_buffer(cmd, h, index32, offset);
+}
+
+void cap_cmd_set_scissor(CommandListHandle cmd, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    record(Op::SetScissor, [&](PayloadWriter& w) { w.put(cmd).put(x).put(y).put(width).put(height); });
+    g_inner.cmd_set_scissor(cmd, x, y, width, height);
+}
+
+void cap_cmd_draw(CommandListHandle cmd, uint32_t vtx_count, uint32_t instance_count, uint32_t first_vtx, uint32_t first_instance) {
+    record(Op::Draw, [&](PayloadWriter& w) { w.put(cmd).put(vtx_count).put(instance_count).put(first_vtx).put(first_instance); });
+    g_inner.cmd_draw(cmd, vtx_count, instance_count, first_vtx, first_instance);
+}
+
+void cap_cmd_draw_indexed(CommandListHandle cmd, uint32_t idx_count, uint32_t inst_count, uint32_t first_idx, int32_t vtx_offset, uint32_t first_instance) {
+    record(Op::DrawIndexed, [&](PayloadWriter& w) { w.put(cmd).put(idx_count).put(inst_count).put(first_idx).put(vtx_offset).put(first_instance); });
+    g_inner.cmd_draw_indexed(cmd, idx_count, inst_count, first_idx, vtx_offset, first_instance);
+}
+
+void cap_end_commands(CommandListHandle cmd) {
+    record(Op::EndCommands, [&](PayloadWriter& w) { w.put(cmd); });
+    g_inner.end_commands(cmd);
+}
+
+void cap_submit(CommandListHandle* lists, uint32_t list_count) {
+    record(Op::Submit, [&](PayloadWriter& w) { w.blob(lists, uint64_t(list_count) * sizeof(CommandListHandle)); });
+    g_inner.submit(lists, list_count);
+}
+
+void cap_present(SwapchainHandle h) {
+    record(Op::Present, [&](PayloadWriter& w) { w.put(h); });
+    g_inner.present(h);
+}
+
+void cap_wait_idle() {
+    record(Op::WaitIdle);
+    g_inner.wait_idle();
+}
+
+// Points each entry the backend provides at its recording wrapper
+template<typename Fn>
+void interpose(Fn*& entry, Fn* wrapper) {
+    if (entry) entry = wrapper;
+}
+
+} // namespace
+
+result<> RenderCapture::start(RendererAPI& api, GfxBackend backend, const std::string& path, uint32_t maxFrames) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    JAENG_ERROR_IF(g_file != nullptr, error_code::invalid_operation, "[RenderCapture] A capture is already running");
+
+    g_file = std::fopen(path.c_str(), "wb");
+    JAENG_ERROR_IF(!g_file, error_code::platform_error, "[RenderCapture] Failed to open " + path);
+
+    FileHeader header{ kMagic, kVersion, static_cast<uint32_t>(backend), 0 };
+    std::fwrite(&header, sizeof(header), 1, g_file);
+
+    // A table can be restarted after stop(); only wrap it once
+    if (api.begin_frame != cap_begin_frame) {
+        g_inner = api;
+        interpose(api.begin_frame, cap_begin_frame);
+        interpose(api.end_frame, cap_end_frame);
+        interpose(api.create_swapchain, cap_create_swapchain);
+        interpose(api.resize_swapchain, cap_resize_swapchain);
+        interpose(api.set_present_mode, cap_set_present_mode);
+        interpose(api.destroy_swapchain, cap_destroy_swapchain);
+        interpose(api.get_current_backbuffer, cap_get_current_backbuffer);
+        interpose(api.get_depth_buffer, cap_get_depth_buffer);
+        interpose(api.create_buffer, cap_create_buffer);
+        interpose(api.destroy_buffer, cap_destroy_buffer);
+        interpose(api.update_buffer, cap_update_buffer);
+        interpose(api.create_texture, cap_create_texture);
+        interpose(api.destroy_texture, cap_destroy_texture);
+        interpose(api.create_sampler, cap_create_sampler);
+        interpose(api.destroy_sampler, cap_destroy_sampler);
+        interpose(api.get_texture_index, cap_get_texture_index);
+        interpose(api.get_sampler_index, cap_get_sampler_index);
+        interpose(api.create_shader_module, cap_create_shader_module);
+        interpose(api.destroy_shader_module, cap_destroy_shader_module);
+        interpose(api.create_vertex_layout, cap_create_vertex_layout);
+        interpose(api.destroy_vertex_layout, cap_destroy_vertex_layout);
+        interpose(api.create_graphics_pipeline, cap_create_graphics_pipeline);
+        interpose(api.destroy_pipeline, cap_destroy_pipeline);
+        interpose(api.begin_commands, cap_begin_commands);
+        interpose(api.cmd_begin_pass, cap_cmd_begin_pass);
+        interpose(api.cmd_end_pass, cap_cmd_end_pass);
+        interpose(api.cmd_bind_uniform, cap_cmd_bind_uniform);
+        interpose(api.cmd_push_constants, cap_cmd_push_constants);
+        interpose(api.cmd_barrier, cap_cmd_barrier);
+        interpose(api.cmd_set_pipeline, cap_cmd_set_pipeline);
+        interpose(api.cmd_set_vertex_buffer, cap_cmd_set_vertex_buffer);
+        interpose(api.cmd_set_index_buffer, cap_cmd_set_index_buffer);
+        interpose(api.cmd_set_scissor, cap_cmd_set_scissor);
+        interpose(api.cmd_draw, cap_cmd_draw);
+        interpose(api.cmd_draw_indexed, cap_cmd_draw_indexed);
+        interpose(api.end_commands, cap_end_commands);
+        interpose(api.submit, cap_submit);
+        interpose(api.present, cap_present);
+        interpose(api.wait_idle, cap_wait_idle);
+    }
+
+    g_maxFrames = maxFrames;
+    g_frames = 0;
+    g_recording.store(true, std::memory_order_release);
+    JAENG_LOG_INFO("[RenderCapture] Recording to {}", path);
+    return {};
+}
+
+void RenderCapture::stop() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    close_locked();
+}
+
+bool RenderCapture::active() {
+    return g_recording.load(std::memory_order_acquire);
+}
+
+uint64_t RenderCapture::frames_recorded() {
+    return g_frames.load(std::memory_order_relaxed);
+}
+
+} // namespace jaeng::renderer
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "common/result.h"
+#include "render/public/renderer_api.h"
+
+namespace jaeng::renderer {
+
+// Records every call made through a RendererAPI table to a binary file (see capture_format.h), for
+// offline replay with tools/render_replay. start() swaps the table's entries for recording ones that
+// serialize the call (arguments, descriptor structs, buffer/texture/shader payloads, returned handles)
+// and forward it to the original backend. Only one table can be captured at a time; the swapped
+// entries stay installed after stop() and just forward, so the table may keep being used from any
+// thread. init/shutdown/set_platform_drawable/get_stats are not recorded.
+class RenderCapture {
+public:
+    // maxFrames > 0 stops recording after that many end_frame calls
+    static result<> start(RendererAPI& api, GfxBackend backend, const std::string& path, uint32_t maxFrames = 0);
+
+    // Flushes and closes the file
+    static void stop();
+
+    static bool active();
+    static uint64_t frames_recorded();
+};
+
+} // namespace jaeng::renderer
@@ -53,11 +53,16 @@ public:
                 gfx = plugin.api;
                 JAENG_LOG_INFO("Loaded Vulkan renderer plugin.");
             }
+        } else if (backend == GfxBackend::Null) {
+            if (plugin.load(L"renderer_null.dll")) {
+                gfx = plugin.api;
+                JAENG_LOG_INFO("Loaded Null renderer plugin.");
+            }
         }
 #else
         bool tryMetal = (backend == GfxBackend::Metal);
 #if defined(JAENG_MACOS) || defined(JAENG_IOS)
-        if (backend != GfxBackend::Vulkan) tryMetal = true; 
+        if (backend != GfxBackend::Vulkan && backend != GfxBackend::Null) tryMetal = true; 
 #endif
 
         // Discovery path: always check next to executable
@@ -101,6 +106,19 @@ public:
 #endif
         }
         
+        if (backend == GfxBackend::Null) {
+            // Optional: without the plugin the built-in no-op table below is used
+            std::string name = "librenderer_null.so";
+#ifdef JAENG_MACOS
+            name = "librenderer_null.dylib";
+#endif
+            std::string fullPath = (std::filesystem::path(exeDir) / name).string();
+            if (plugin.load(fullPath.c_str()) || plugin.load(name.c_str())) {
+                gfx = plugin.api;
+                JAENG_LOG_INFO("Loaded Null renderer plugin.");
+            }
+        }
+
         if (tryMetal) {
 #ifdef JAENG_IOS
             gfx = std::make_shared<RendererAPI>();
@@ -210,13 +228,16 @@ public:
         pending_mode_change_.store(true, std::memory_order_release);
     }
 
-    void process_pending_resizes() {
+    // Returns true if the swapchain was resized or changed mode
+    bool process_pending_resizes() {
+        bool changed = false;
         if (pending_resize_.exchange(false, std::memory_order_acquire)) {
             uint32_t w = new_width_.load(std::memory_order_relaxed);
             uint32_t h = new_height_.load(std::memory_order_relaxed);
             if (gfx && gfx->resize_swapchain && resize_handle_ > 0 && w > 0 && h > 0) {
                 // Safely execute the backend resize on the current thread
                 gfx->resize_swapchain(resize_handle_, { w, h });
+                changed = true;
             }
         }
 
@@ -224,8 +245,10 @@ public:
             PresentMode mode = static_cast<PresentMode>(new_present_mode_.load(std::memory_order_relaxed));
             if (gfx && gfx->set_present_mode && resize_handle_ > 0) {
                 gfx->set_present_mode(resize_handle_, mode);
+                changed = true;
             }
         }
+        return changed;
     }
 
     std::shared_ptr<RendererAPI> gfx{};
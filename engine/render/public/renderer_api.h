@@ -25,7 +25,9 @@ typedef RendererHandle SwapchainHandle;
 typedef RendererHandle CommandListHandle;
 
 // --- Enums ---
-enum class GfxBackend : uint32_t { D3D12=0, Vulkan=1, OpenGL=2, Metal=3 };
+// Null renders nothing: the renderer_null plugin only tracks resources and counts calls (see
+// RendererStats); without it the frontend falls back to a built-in no-op table
+enum class GfxBackend : uint32_t { D3D12=0, Vulkan=1, OpenGL=2, Metal=3, Null=4 };
 
 enum class TextureFormat : uint32_t { RGBA8_UNORM=0, BGRA8_UNORM=1, D24S8=2, D32F=3 };
 
@@ -169,6 +171,33 @@ struct DepthAttachmentDesc {
     float clear_d;
 };
 
+// Work submitted through the API during one frame (begin_frame to end_frame), for benchmarking.
+// Calls made outside a frame (e.g. resource uploads at load time) count towards the next one.
+struct RendererStats {
+    uint64_t frame;               // Frames completed so far; the counters below are for the last one
+    uint32_t draw_calls;
+    uint32_t instances;           // Sum of instance counts over all draws
+    uint64_t vertices;            // Vertices (or indices) times instances
+    uint32_t passes;
+    uint32_t pipeline_binds;
+    uint32_t uniform_binds;
+    uint32_t vertex_buffer_binds;
+    uint32_t index_buffer_binds;
+    uint32_t push_constant_calls;
+    uint32_t barriers;
+    uint32_t command_lists;
+    uint32_t submits;
+    uint32_t buffer_updates;
+    uint64_t bytes_uploaded;      // update_buffer payloads plus initial data of created resources
+    uint32_t resources_created;
+    uint32_t resources_destroyed;
+    uint32_t invalid_calls;       // Calls with unknown or destroyed handles, or out of range updates
+    // Live objects at the end of the frame
+    uint32_t live_buffers;
+    uint32_t live_textures;
+    uint32_t live_pipelines;
+};
+
 extern "C" {
 
 // --- Renderer function table ---
@@ -233,6 +262,9 @@ typedef struct RendererAPI {
     void (*submit)(CommandListHandle* lists, uint32_t list_count);
     void (*present)(SwapchainHandle);
     void (*wait_idle)();
+
+    // optional: stats of the last completed frame, false if unsupported (may be null)
+    bool (*get_stats)(RendererStats* out);
 } RendererAPI;
 
 typedef bool (*PFN_LoadRenderer)(RendererAPI* out_api);
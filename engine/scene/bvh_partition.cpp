@@ -0,0 +1,516 @@
+#include "bvh_partition.h"
+#include "partition_query.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace jaeng {
+    namespace {
+        constexpr uint32_t kSahBins = 12;
+        // Below this many proxies the tree cost is not worth tracking
+        constexpr uint32_t kMinRebuildProxies = 64;
+
+        float area(const math::AABB& b) {
+            math::vec3 d = b.max - b.min;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        math::AABB merged(const math::AABB& a, const math::AABB& b) {
+            return { math::min(a.min, b.min), math::max(a.max, b.max) };
+        }
+
+        bool encloses(const math::AABB& outer, const math::AABB& inner) {
+            return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+                   outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+        }
+
+        // Slab test against a precomputed inverse direction, returns the entry distance or infinity
+        float rayHit(const math::AABB& b, const math::vec3& origin, const math::vec3& invDir, float maxT) {
+            math::vec3 t0 = (b.min - origin) * invDir;
+            math::vec3 t1 = (b.max - origin) * invDir;
+            math::vec3 tmin = math::min(t0, t1);
+            math::vec3 tmax = math::max(t0, t1);
+            float enter = std::max(std::max(tmin.x, tmin.y), std::max(tmin.z, 0.0f));
+            float exit = std::min(std::min(tmax.x, tmax.y), std::min(tmax.z, maxT));
+            return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+        }
+    }
+
+    BvhPartitioner::BvhPartitioner(float margin, float rebuildThreshold)
+        : margin_(std::max(margin, 0.0f))
+        , rebuildThreshold_(std::max(rebuildThreshold, 1.0f))
+    {}
+
+    math::AABB BvhPartitioner::fatten(const math::AABB& bounds) const {
+        return { bounds.min - math::vec3(margin_), bounds.max + math::vec3(margin_) };
+    }
+
+    int32_t BvhPartitioner::allocNode() {
+        int32_t node;
+        if (freeList_ != kNull) {
+            node = freeList_;
+            freeList_ = nodes_[node].parent;
+        } else {
+            node = static_cast<int32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        nodes_[node] = { {}, kNull, kNull, kNull, 0, 0 };
+        return node;
+    }
+
+    void BvhPartitioner::freeNode(int32_t node) {
+        // Free nodes are chained through parent
+        nodes_[node].parent = freeList_;
+        nodes_[node].height = -1;
+        freeList_ = node;
+    }
+
+    void BvhPartitioner::insertLeaf(int32_t leaf, int32_t start) {
+        if (root_ == kNull) {
+            root_ = leaf;
+            nodes_[leaf].parent = kNull;
+            return;
+        }
+
+        // Descend towards the sibling with the lowest surface area cost
+        const math::AABB leafBounds = nodes_[leaf].bounds;
+        int32_t index = start != kNull ? start : root_;
+        while (!nodes_[index].isLeaf()) {
+            const Node& node = nodes_[index];
+            float nodeArea = area(node.bounds);
+            float combinedArea = area(merged(node.bounds, leafBounds));
+
+            // Pairing with this node creates a parent of combinedArea; going deeper also grows this node
+            float cost = 2.0f * combinedArea;
+            float inheritance = 2.0f * (combinedArea - nodeArea);
+
+            auto childCost = [&](int32_t child) {
+                const Node& c = nodes_[child];
+                float grown = area(merged(c.bounds, leafBounds));
+                return (c.isLeaf() ? grown : grown - area(c.bounds)) + inheritance;
+            };
+            float costLeft = childCost(node.left);
+            float costRight = childCost(node.right);
+
+            if (cost < costLeft && cost < costRight) break;
+            index = costLeft < costRight ? node.left : node.right;
+        }
+
+        int32_t sibling = index;
+        int32_t oldParent = nodes_[sibling].parent;
+        int32_t newParent = allocNode();
+        nodes_[newParent].parent = oldParent;
+        nodes_[newParent].left = sibling;
+        nodes_[newParent].right = leaf;
+        nodes_[sibling].parent = newParent;
+        nodes_[leaf].parent = newParent;
+
+        if (oldParent == kNull) {
+            root_ = newParent;
+        } else if (nodes_[oldParent].left == sibling) {
+            nodes_[oldParent].left = newParent;
+        } else {
+            nodes_[oldParent].right = newParent;
+        }
+
+        // The new parent pairs a single leaf with a possibly tall subtree, so balancing starts there.
+        // Its height and bounds are left unset for refitUpwards to fill in.
+        refitUpwards(newParent);
+    }
+
+    void BvhPartitioner::removeLeaf(int32_t leaf) {
+        if (leaf == root_) {
+            root_ = kNull;
+            return;
+        }
+
+        int32_t parent = nodes_[leaf].parent;
+        int32_t grandParent = nodes_[parent].parent;
+        int32_t sibling = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+
+        // The sibling takes the parent's place
+        nodes_[sibling].parent = grandParent;
+        if (grandParent == kNull) {
+            root_ = sibling;
+        } else if (nodes_[grandParent].left == parent) {
+            nodes_[grandParent].left = sibling;
+        } else {
+            nodes_[grandParent].right = sibling;
+        }
+        freeNode(parent);
+        refitUpwards(grandParent);
+    }
+
+    void BvhPartitioner::refitUpwards(int32_t index) {
+        while (index != kNull) {
+            int32_t top = balance(index);
+            Node& node = nodes_[top];
+            int32_t height = 1 + std::max(nodes_[node.left].height, nodes_[node.right].height);
+            math::AABB bounds = merged(nodes_[node.left].bounds, nodes_[node.right].bounds);
+
+            // A node that kept its place, height and bounds leaves everything above it as it was
+            if (top == index && height == node.height && bounds.min == node.bounds.min && bounds.max == node.bounds.max) return;
+            node.height = height;
+            node.bounds = bounds;
+            index = node.parent;
+        }
+    }
+
+    // Rotates the taller child up when the subtree heights differ by more than one.
+    // Returns the node now at this position.
+    int32_t BvhPartitioner::balance(int32_t iA) {
+        Node& A = nodes_[iA];
+        // Child heights decide, A's own may not be filled in yet
+        if (A.isLeaf()) return iA;
+
+        int32_t iB = A.left;
+        int32_t iC = A.right;
+        int32_t diff = nodes_[iC].height - nodes_[iB].height;
+        if (diff >= -1 && diff <= 1) return iA;
+
+        // Up is the taller child; its taller child stays with it, the other one moves under A
+        bool rightHeavy = diff > 0;
+        int32_t iUp = rightHeavy ? iC : iB;
+        int32_t iOther = rightHeavy ? iB : iC;
+        Node& Up = nodes_[iUp];
+        int32_t iF = Up.left;
+        int32_t iG = Up.right;
+
+        Up.left = iA;
+        Up.parent = A.parent;
+        A.parent = iUp;
+        if (Up.parent == kNull) {
+            root_ = iUp;
+        } else if (nodes_[Up.parent].left == iA) {
+            nodes_[Up.parent].left = iUp;
+        } else {
+            nodes_[Up.parent].right = iUp;
+        }
+
+        int32_t iKeep = nodes_[iF].height > nodes_[iG].height ? iF : iG;
+        int32_t iMove = iKeep == iF ? iG : iF;
+        Up.right = iKeep;
+        if (rightHeavy) A.right = iMove; else A.left = iMove;
+        nodes_[iMove].parent = iA;
+
+        A.bounds = merged(nodes_[iOther].bounds, nodes_[iMove].bounds);
+        A.height = 1 + std::max(nodes_[iOther].height, nodes_[iMove].height);
+        Up.bounds = merged(A.bounds, nodes_[iKeep].bounds);
+        Up.height = 1 + std::max(A.height, nodes_[iKeep].height);
+        return iUp;
+    }
+
+    void BvhPartitioner::addOrUpdate(const RenderProxy& proxy) {
+        math::AABB bounds = proxy.bounds;
+
+        auto [it, inserted] = index_.try_emplace(proxy.id, static_cast<uint32_t>(entries_.size()));
+        if (inserted) {
+            entries_.push_back({ proxy, bounds, kNull });
+            pending_.push_back(proxy.id);
+            return;
+        }
+
+        Entry& e = entries_[it->second];
+        e.proxy = proxy;
+        e.bounds = bounds;
+        if (e.leaf == kNull || encloses(nodes_[e.leaf].bounds, bounds)) return;
+
+        // Most moves are small: the lowest ancestor above the parent (which removeLeaf frees) that
+        // still encloses the new bounds is where the leaf goes back in, so neither removal nor
+        // insertion walks the whole tree
+        math::AABB fat = fatten(bounds);
+        int32_t start = nodes_[e.leaf].parent;
+        start = start != kNull ? nodes_[start].parent : kNull;
+        while (start != kNull && !encloses(nodes_[start].bounds, fat)) start = nodes_[start].parent;
+
+        removeLeaf(e.leaf);
+        nodes_[e.leaf].bounds = fat;
+        insertLeaf(e.leaf, start);
+        ++reinsertsSinceBuild_;
+    }
+
+    void BvhPartitioner::remove(uint32_t id) {
+        auto it = index_.find(id);
+        if (it == index_.end()) return;
+        uint32_t index = it->second;
+        index_.erase(it);
+
+        if (entries_[index].leaf == kNull) {
+            // Recently added proxies sit at the back
+            auto pending = std::find(pending_.rbegin(), pending_.rend(), id);
+            *pending = pending_.back();
+            pending_.pop_back();
+        } else {
+            removeLeaf(entries_[index].leaf);
+            freeNode(entries_[index].leaf);
+            ++reinsertsSinceBuild_;
+        }
+
+        uint32_t last = static_cast<uint32_t>(entries_.size() - 1);
+        if (index != last) {
+            entries_[index] = std::move(entries_[last]);
+            if (entries_[index].leaf != kNull) nodes_[entries_[index].leaf].entry = index;
+            index_[entries_[index].proxy.id] = index;
+        }
+        entries_.pop_back();
+    }
+
+    const RenderProxy* BvhPartitioner::find(uint32_t id) const {
+        auto it = index_.find(id);
+        return it != index_.end() ? &entries_[it->second].proxy : nullptr;
+    }
+
+    float BvhPartitioner::getCost() const {
+        float cost = 0.0f;
+        for (const Node& node : nodes_) {
+            if (node.height > 0) cost += area(node.bounds);
+        }
+        return cost;
+    }
+
+    void BvhPartitioner::build() {
+        if (!pending_.empty()) {
+            // A big batch builds a better tree faster from scratch
+            size_t inTree = entries_.size() - pending_.size();
+            if (pending_.size() >= kMinRebuildProxies && pending_.size() > inTree / 4) {
+                rebuild();
+                return;
+            }
+
+            for (uint32_t id : pending_) {
+                auto it = index_.find(id);
+                int32_t leaf = allocNode();
+                nodes_[leaf].bounds = fatten(entries_[it->second].bounds);
+                nodes_[leaf].entry = it->second;
+                entries_[it->second].leaf = leaf;
+                insertLeaf(leaf);
+                ++reinsertsSinceBuild_;
+            }
+            pending_.clear();
+        }
+
+        // Checking the cost is O(n), only do it once a good part of the tree has been reinserted
+        if (entries_.size() < kMinRebuildProxies || reinsertsSinceBuild_ < entries_.size() / 2) return;
+        reinsertsSinceBuild_ = 0;
+        if (getCost() > builtCost_ * rebuildThreshold_) rebuild();
+    }
+
+    void BvhPartitioner::rebuild() {
+        nodes_.clear();
+        freeList_ = kNull;
+        root_ = kNull;
+        reinsertsSinceBuild_ = 0;
+        if (entries_.empty()) {
+            builtCost_ = 0.0f;
+            return;
+        }
+
+        pending_.clear();
+        std::vector<BuildItem> items(entries_.size());
+        nodes_.reserve(entries_.size() * 2);
+        for (uint32_t i = 0; i < entries_.size(); ++i) {
+            int32_t leaf = allocNode();
+            nodes_[leaf].bounds = fatten(entries_[i].bounds);
+            nodes_[leaf].entry = i;
+            entries_[i].leaf = leaf;
+            items[i] = { nodes_[leaf].bounds, nodes_[leaf].bounds.center(), leaf };
+        }
+
+        root_ = buildRange(items.data(), static_cast<uint32_t>(items.size()));
+        nodes_[root_].parent = kNull;
+        builtCost_ = getCost();
+    }
+
+    // Splits the items along the axis of largest centroid spread, at the bin boundary with the lowest
+    // surface area cost; falls back to a median split when all centroids fall in one bin
+    int32_t BvhPartitioner::buildRange(BuildItem* items, uint32_t count) {
+        if (count == 1) return items[0].leaf;
+
+        math::AABB bounds = items[0].bounds;
+        math::AABB centroids{ items[0].centroid, items[0].centroid };
+        for (uint32_t i = 1; i < count; ++i) {
+            bounds = merged(bounds, items[i].bounds);
+            centroids.min = math::min(centroids.min, items[i].centroid);
+            centroids.max = math::max(centroids.max, items[i].centroid);
+        }
+        math::vec3 spread = centroids.max - centroids.min;
+        int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+
+        uint32_t mid = 0;
+        if (spread[axis] > 0.0f) {
+            struct Bin { math::AABB bounds; uint32_t count = 0; };
+            std::array<Bin, kSahBins> bins;
+            float origin = centroids.min[axis];
+            float scale = kSahBins / spread[axis];
+            auto binOf = [&](const BuildItem& item) {
+                return std::min(kSahBins - 1, static_cast<uint32_t>((item.centroid[axis] - origin) * scale));
+            };
+            for (uint32_t i = 0; i < count; ++i) {
+                Bin& bin = bins[binOf(items[i])];
+                bin.bounds = bin.count ? merged(bin.bounds, items[i].bounds) : items[i].bounds;
+                ++bin.count;
+            }
+
+            // Sweep from the right, then from the left, costing each split
+            std::array<float, kSahBins> rightCost{};
+            math::AABB acc{};
+            uint32_t accCount = 0;
+            for (uint32_t b = kSahBins - 1; b > 0; --b) {
+                if (bins[b].count) {
+                    acc = accCount ? merged(acc, bins[b].bounds) : bins[b].bounds;
+                    accCount += bins[b].count;
+                }
+                rightCost[b] = accCount ? area(acc) * accCount : 0.0f;
+            }
+
+            float bestCost = std::numeric_limits<float>::max();
+            uint32_t bestSplit = 0;
+            accCount = 0;
+            for (uint32_t b = 0; b + 1 < kSahBins; ++b) {
+                if (bins[b].count) {
+                    acc = accCount ? merged(acc, bins[b].bounds) : bins[b].bounds;
+                    accCount += bins[b].count;
+                }
+                if (accCount == 0 || accCount == count) continue;
+                float cost = area(acc) * accCount + rightCost[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestSplit = b + 1;
+                }
+            }
+
+            if (bestSplit > 0) {
+                BuildItem* split = std::partition(items, items + count, [&](const BuildItem& item) { return binOf(item) < bestSplit; });
+                mid = static_cast<uint32_t>(split - items);
+            }
+        }
+        if (mid == 0 || mid == count) {
+            mid = count / 2;
+            std::nth_element(items, items + mid, items + count, [axis](const BuildItem& a, const BuildItem& b) {
+                return a.centroid[axis] < b.centroid[axis];
+            });
+        }
+
+        int32_t left = buildRange(items, mid);
+        int32_t right = buildRange(items + mid, count - mid);
+        int32_t node = allocNode();
+        nodes_[node].left = left;
+        nodes_[node].right = right;
+        nodes_[node].bounds = bounds;
+        nodes_[node].height = 1 + std::max(nodes_[left].height, nodes_[right].height);
+        nodes_[left].parent = node;
+        nodes_[right].parent = node;
+        return node;
+    }
+
+    void BvhPartitioner::reset() {
+        nodes_.clear();
+        entries_.clear();
+        index_.clear();
+        pending_.clear();
+        freeList_ = kNull;
+        root_ = kNull;
+        reinsertsSinceBuild_ = 0;
+        builtCost_ = 0.0f;
+    }
+
+    void BvhPartitioner::queryVisible(const jaeng::math::AABB& volume, std::vector<uint32_t>& out) const {
+        out.clear();
+        forEachPending([&](uint32_t index) {
+            if (entries_[index].bounds.intersects(volume)) out.push_back(index);
+        });
+        if (root_ == kNull) return;
+
+        QueryStack<int32_t> stack(getHeight() + 1);
+        stack.push(root_);
+        while (!stack.empty()) {
+            const Node& node = nodes_[stack.pop()];
+            if (!node.bounds.intersects(volume)) continue;
+            if (node.isLeaf()) {
+                if (entries_[node.entry].bounds.intersects(volume)) out.push_back(node.entry);
+            } else {
+                stack.push(node.left);
+                stack.push(node.right);
+            }
+        }
+    }
+
+    void BvhPartitioner::queryFrustum(const math::Frustum& frustum, std::vector<uint32_t>& out) const {
+        out.clear();
+
+        // Leaves reached outside a fully visible subtree have their tight bounds tested in batches,
+        // skipping the fat bounds test
+        FrustumBatch batch(frustum, out, [this](uint32_t index) { return entries_[index].bounds; });
+        forEachPending([&](uint32_t index) { batch.add(index); });
+        if (root_ == kNull) return;
+
+        // The low bit marks subtrees already known to be fully inside
+        QueryStack<int32_t> stack(getHeight() + 1);
+        stack.push(root_ << 1);
+        while (!stack.empty()) {
+            int32_t item = stack.pop();
+            const Node& node = nodes_[item >> 1];
+            bool inside = item & 1;
+
+            if (node.isLeaf()) {
+                if (inside) out.push_back(node.entry);
+                else batch.add(node.entry);
+                continue;
+            }
+            if (!inside) {
+                auto side = frustum.classify(node.bounds);
+                if (side == math::Frustum::Result::Outside) continue;
+                inside = side == math::Frustum::Result::Inside;
+            }
+            stack.push((node.left << 1) | int32_t(inside));
+            stack.push((node.right << 1) | int32_t(inside));
+        }
+    }
+
+    const RenderProxy* BvhPartitioner::raycast(const math::Ray& ray, float maxDistance, float* outDistance) const {
+        math::vec3 invDir = 1.0f / ray.direction;
+        float best = maxDistance;
+        const RenderProxy* hit = nullptr;
+        forEachPending([&](uint32_t index) {
+            const Entry& e = entries_[index];
+            float t = rayHit(e.bounds, ray.origin, invDir, best);
+            if (t <= best) {
+                best = t;
+                hit = &e.proxy;
+            }
+        });
+
+        QueryStack<int32_t> stack(getHeight() + 1);
+        if (root_ != kNull) stack.push(root_);
+        while (!stack.empty()) {
+            const Node& node = nodes_[stack.pop()];
+            if (rayHit(node.bounds, ray.origin, invDir, best) > best) continue;
+
+            if (node.isLeaf()) {
+                const Entry& e = entries_[node.entry];
+                float t = rayHit(e.bounds, ray.origin, invDir, best);
+                if (t <= best) {
+                    best = t;
+                    hit = &e.proxy;
+                }
+                continue;
+            }
+
+            // Visit the nearer child first so it can shrink the range for the other
+            float tl = rayHit(nodes_[node.left].bounds, ray.origin, invDir, best);
+            float tr = rayHit(nodes_[node.right].bounds, ray.origin, invDir, best);
+            if (tl <= tr) {
+                if (tr <= best) stack.push(node.right);
+                if (tl <= best) stack.push(node.left);
+            } else {
+                if (tl <= best) stack.push(node.left);
+                if (tr <= best) stack.push(node.right);
+            }
+        }
+
+        if (hit && outDistance) *outDistance = best;
+        return hit;
+    }
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "ipartition.h"
+#include "common/math/ray.h"
+#include <unordered_map>
+
+namespace jaeng {
+
+    // Dynamic AABB tree. Leaves hold "fat" bounds (the proxy bounds grown by a margin), so a proxy
+    // moving inside them costs nothing; one that leaves them is removed and reinserted, descending by
+    // surface area cost and rebalancing with AVL style rotations on the way up. New proxies wait in a
+    // pending list (still visible to queries) until build(), which inserts them one by one or, for a
+    // large batch such as a level load, rebuilds the whole tree top-down with a binned SAH. Incremental
+    // updates degrade the tree over time, so build() also rebuilds once its cost has grown past
+    // rebuildThreshold times the cost of the last rebuild. Suits scenes with very uneven object
+    // density, where a uniform grid has either too many empty or too crowded cells.
+    class BvhPartitioner : public ISpatialPartitioner {
+    public:
+        explicit BvhPartitioner(float margin = 0.25f, float rebuildThreshold = 1.5f);
+
+        void addOrUpdate(const RenderProxy& proxy) override;
+        void remove(uint32_t id) override;
+        const RenderProxy* find(uint32_t id) const override;
+
+        // Inserts pending proxies, rebuilds when the tree cost degraded
+        void build() override;
+
+        // Top-down SAH build over all proxies, refitting the fat bounds
+        void rebuild() override;
+
+        // Clears existing partition
+        void reset() override;
+
+        // Proxies whose bounds overlap the volume
+        void queryVisible(const jaeng::math::AABB& volume, std::vector<uint32_t>& out) const override;
+
+        // Proxies whose bounds intersect the frustum; subtrees fully inside skip the plane tests
+        void queryFrustum(const math::Frustum& frustum, std::vector<uint32_t>& out) const override;
+
+        const RenderProxy& getProxy(uint32_t index) const override { return entries_[index].proxy; }
+
+        // Nearest proxy whose bounds the ray hits within maxDistance, nullptr if none
+        const RenderProxy* raycast(const math::Ray& ray, float maxDistance, float* outDistance = nullptr) const;
+
+        // Sum of the internal node surface areas (SAH cost without the constant factors)
+        float getCost() const;
+        int32_t getHeight() const { return root_ == kNull ? 0 : nodes_[root_].height; }
+
+    private:
+        static constexpr int32_t kNull = -1;
+
+        struct Node {
+            math::AABB bounds;
+            int32_t parent;
+            int32_t left;
+            int32_t right;
+            int32_t height;   // Leaves are 0
+            uint32_t entry;   // Leaves only: position in entries_
+            bool isLeaf() const { return left == kNull; }
+        };
+
+        struct Entry {
+            RenderProxy proxy;
+            math::AABB bounds;
+            int32_t leaf;
+        };
+
+        int32_t allocNode();
+        void freeNode(int32_t node);
+        // Descends from start (the root by default) to the sibling with the lowest SAH cost
+        void insertLeaf(int32_t leaf, int32_t start = kNull);
+        void removeLeaf(int32_t leaf);
+        int32_t balance(int32_t node);
+        void refitUpwards(int32_t node);
+        struct BuildItem {
+            math::AABB bounds;
+            math::vec3 centroid;
+            int32_t leaf;
+        };
+        int32_t buildRange(BuildItem* items, uint32_t count);
+        math::AABB fatten(const math::AABB& bounds) const;
+
+        // Calls fn with the entries_ position of each pending proxy
+        template<typename Fn>
+        void forEachPending(Fn&& fn) const {
+            for (uint32_t id : pending_) fn(index_.find(id)->second);
+        }
+
+        float margin_;
+        float rebuildThreshold_;
+        std::vector<Node> nodes_;
+        int32_t freeList_ = kNull;
+        int32_t root_ = kNull;
+        std::vector<Entry> entries_;                      // Dense, swap-removed
+        std::unordered_map<uint32_t, uint32_t> index_;    // Proxy id -> entries_ position
+        std::vector<uint32_t> pending_;                   // Ids added since build(), not in the tree yet
+        uint32_t reinsertsSinceBuild_ = 0;
+        float builtCost_ = 0.0f;
+    };
+}
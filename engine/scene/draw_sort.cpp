@@ -0,0 +1,65 @@
+#include "draw_sort.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace jaeng {
+    namespace {
+        constexpr uint64_t kBlendedLayer = uint64_t(1) << 62;
+
+        // Depth in [0, 1] as a bits wide integer
+        uint64_t quantizeDepth(float depth, int bits) {
+            const uint64_t maxValue = (uint64_t(1) << bits) - 1;
+            // Also maps NaN to 0
+            if (!(depth > 0.0f)) return 0;
+            if (depth >= 1.0f) return maxValue;
+            return uint64_t(double(depth) * double(maxValue));
+        }
+    }
+
+    uint64_t makeOpaqueDrawKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth) {
+        return (uint64_t(pipeline & 0xFFFF) << 46) |
+               (uint64_t(material & 0x3FFF) << 32) |
+               (uint64_t(mesh & 0xFFFF) << 16) |
+               quantizeDepth(depth, 16);
+    }
+
+    uint64_t makeBlendedDrawKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth) {
+        return kBlendedLayer |
+               ((0xFFFFFF - quantizeDepth(depth, 24)) << 38) |
+               (uint64_t(pipeline & 0xFFF) << 26) |
+               (uint64_t(material & 0xFFF) << 14) |
+               uint64_t(mesh & 0x3FFF);
+    }
+
+    void radixSortDraws(std::vector<DrawSortItem>& items, std::vector<DrawSortItem>& scratch) {
+        const size_t count = items.size();
+        if (count < 2) return;
+
+        // All eight histograms in a single read
+        uint32_t histograms[8][256] = {};
+        for (const DrawSortItem& item : items) {
+            for (int pass = 0; pass < 8; ++pass) ++histograms[pass][(item.key >> (pass * 8)) & 0xFF];
+        }
+
+        scratch.resize(count);
+        DrawSortItem* src = items.data();
+        DrawSortItem* dst = scratch.data();
+        for (int pass = 0; pass < 8; ++pass) {
+            uint32_t* histogram = histograms[pass];
+            const int shift = pass * 8;
+            if (histogram[(src[0].key >> shift) & 0xFF] == count) continue;
+
+            uint32_t offset = 0;
+            for (int digit = 0; digit < 256; ++digit) {
+                uint32_t n = histogram[digit];
+                histogram[digit] = offset;
+                offset += n;
+            }
+            for (size_t i = 0; i < count; ++i) dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+            std::swap(src, dst);
+        }
+
+        if (src != items.data()) std::copy(src, src + count, items.data());
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Sort keys ordering the draws of a frame. The top bits select the layer, so every opaque draw comes
+// before every blended one:
+//
+//   opaque:  [63:62] 0 | [61:46] pipeline | [45:32] material | [31:16] mesh | [15:0] depth, near first
+//   blended: [63:62] 1 | [61:38] depth, far first | [37:26] pipeline | [25:14] material | [13:0] mesh
+//
+// Opaque draws group by state and go front to back within it (for early depth rejection, where a
+// coarse depth is enough); blended ones must go back to front, state only breaking ties. Mesh and
+// material handles are below MeshSystem::MAX_MESH_ENTRIES / MaterialSystem::MAX_MATERIALS (1024),
+// so their fields hold them whole and draws of one mesh stay adjacent for instancing. Pipeline
+// handles keep their low bits only, so two of them may share a field: that costs a state change,
+// never correctness, as batches compare the actual handles.
+
+namespace jaeng {
+
+    struct DrawSortItem {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    // Depth is the normalized device depth, clamped to [0, 1]
+    uint64_t makeOpaqueDrawKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+    uint64_t makeBlendedDrawKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+
+    // Stable LSD radix sort on the key, 8 bits per pass. Passes where every key has the same digit
+    // are skipped, so keys that only differ in a few fields sort in a few passes. scratch is resized
+    // as needed and kept by the caller across frames.
+    void radixSortDraws(std::vector<DrawSortItem>& items, std::vector<DrawSortItem>& scratch);
+}
@@ -1,26 +1,197 @@
 #include "grid_partition.h"
+#include "partition_query.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace jaeng {
+    namespace {
+        // Cell coordinates are packed into 21 bits each, enough for +-1M cells per axis
+        constexpr int32_t kCellLimit = (1 << 20) - 1;
+    }
+
+    GridPartitioner::GridPartitioner(float cellSize)
+        : cellSize_(cellSize > 0.0f ? cellSize : 8.0f)
+        , invCellSize_(1.0f / cellSize_)
+    {}
+
+    math::ivec3 GridPartitioner::cellCoord(const math::vec3& p) const {
+        auto axis = [this](float v) {
+            float c = std::floor(v * invCellSize_);
+            if (std::isnan(c)) return 0;
+            return static_cast<int32_t>(std::clamp(c, float(-kCellLimit), float(kCellLimit)));
+        };
+        return { axis(p.x), axis(p.y), axis(p.z) };
+    }
+
+    GridPartitioner::CellKey GridPartitioner::cellKey(const math::ivec3& c) {
+        constexpr uint64_t mask = (1u << 21) - 1;
+        return (uint64_t(uint32_t(c.x)) & mask) | ((uint64_t(uint32_t(c.y)) & mask) << 21) | ((uint64_t(uint32_t(c.z)) & mask) << 42);
+    }
+
+    math::ivec3 GridPartitioner::cellFromKey(CellKey key) {
+        // Sign-extends each 21 bit field
+        auto axis = [key](int shift) { return static_cast<int32_t>(int64_t(key << (43 - shift)) >> 43); };
+        return { axis(0), axis(21), axis(42) };
+    }
+
+    bool GridPartitioner::isOversized(const math::AABB& bounds) const {
+        math::vec3 size = bounds.max - bounds.min;
+        return std::max(size.x, std::max(size.y, size.z)) > cellSize_;
+    }
+
+    void GridPartitioner::growOccupied(const math::ivec3& c) {
+        if (minCell_.x > maxCell_.x) {
+            minCell_ = maxCell_ = c;
+        } else {
+            minCell_ = math::min(minCell_, c);
+            maxCell_ = math::max(maxCell_, c);
+        }
+    }
+
+    void GridPartitioner::link(uint32_t index) {
+        Entry& e = entries_[index];
+        e.oversized = isOversized(e.bounds);
+        if (e.oversized) {
+            e.slot = static_cast<uint32_t>(oversized_.size());
+            oversized_.push_back(index);
+            return;
+        }
+
+        math::ivec3 c = cellCoord(e.bounds.center());
+        e.cell = cellKey(c);
+        auto& cell = cells_[e.cell];
+        e.slot = static_cast<uint32_t>(cell.size());
+        cell.push_back(index);
+        growOccupied(c);
+    }
+
+    void GridPartitioner::unlink(uint32_t index) {
+        const Entry& e = entries_[index];
+        std::vector<uint32_t>* list = &oversized_;
+        auto cellIt = cells_.end();
+        if (!e.oversized) {
+            cellIt = cells_.find(e.cell);
+            list = &cellIt->second;
+        }
+
+        // Swap-remove, fixing up the slot of the entry that moved
+        uint32_t moved = list->back();
+        (*list)[e.slot] = moved;
+        entries_[moved].slot = e.slot;
+        list->pop_back();
+        if (!e.oversized && list->empty()) cells_.erase(cellIt);
+    }
+
     void GridPartitioner::addOrUpdate(const RenderProxy& proxy) {
-        proxies_[proxy.id] = proxy;
+        math::AABB bounds = proxy.bounds;
+
+        auto [it, inserted] = index_.try_emplace(proxy.id, static_cast<uint32_t>(entries_.size()));
+        if (inserted) {
+            entries_.push_back({ proxy, bounds, 0, false, 0 });
+            link(it->second);
+            return;
+        }
+
+        // Only relink when the proxy crossed into another cell (or changed size class)
+        uint32_t index = it->second;
+        Entry& e = entries_[index];
+        bool oversized = isOversized(bounds);
+        bool sameCell = oversized == e.oversized && (oversized || cellKey(cellCoord(bounds.center())) == e.cell);
+
+        e.proxy = proxy;
+        e.bounds = bounds;
+        if (!sameCell) {
+            unlink(index);
+            link(index);
+        }
     }
 
     void GridPartitioner::remove(uint32_t id) {
-        proxies_.erase(id);
+        auto it = index_.find(id);
+        if (it == index_.end()) return;
+        uint32_t index = it->second;
+        index_.erase(it);
+        unlink(index);
+
+        // Move the last entry into the hole and repoint its cell slot
+        uint32_t last = static_cast<uint32_t>(entries_.size() - 1);
+        if (index != last) {
+            Entry& moved = entries_[last];
+            std::vector<uint32_t>& list = moved.oversized ? oversized_ : cells_[moved.cell];
+            list[moved.slot] = index;
+            index_[moved.proxy.id] = index;
+            entries_[index] = std::move(moved);
+        }
+        entries_.pop_back();
+    }
+
+    const RenderProxy* GridPartitioner::find(uint32_t id) const {
+        auto it = index_.find(id);
+        return it != index_.end() ? &entries_[it->second].proxy : nullptr;
     }
 
     void GridPartitioner::build() {}
-    void GridPartitioner::rebuild() {}
-    void GridPartitioner::reset() { 
-        proxies_.clear(); 
+
+    void GridPartitioner::rebuild() {
+        minCell_ = math::ivec3(0);
+        maxCell_ = math::ivec3(-1);
+        for (const auto& [key, cell] : cells_) {
+            growOccupied(cellFromKey(key));
+        }
     }
 
-    std::vector<RenderProxy> GridPartitioner::queryVisible(const jaeng::math::AABB& /*volume*/) const {
-        std::vector<RenderProxy> result;
-        result.reserve(proxies_.size());
-        for (const auto& [id, proxy] : proxies_) {
-            result.push_back(proxy);
+    void GridPartitioner::reset() {
+        entries_.clear();
+        index_.clear();
+        cells_.clear();
+        oversized_.clear();
+        minCell_ = math::ivec3(0);
+        maxCell_ = math::ivec3(-1);
+    }
+
+    template<typename Fn>
+    void GridPartitioner::forEachCandidate(const math::AABB& volume, Fn&& fn) const {
+        for (uint32_t index : oversized_) fn(index);
+
+        // Cells whose loose bounds (widened by half a cell) overlap the volume, within the occupied range
+        math::vec3 pad(cellSize_ * 0.5f);
+        math::ivec3 lo = math::max(cellCoord(volume.min - pad), minCell_);
+        math::ivec3 hi = math::min(cellCoord(volume.max + pad), maxCell_);
+        if (lo.x > hi.x || lo.y > hi.y || lo.z > hi.z) return;
+
+        // Walk the range when it is smaller than the occupied cell set, the cell set otherwise
+        uint64_t rangeCells = uint64_t(hi.x - lo.x + 1) * uint64_t(hi.y - lo.y + 1) * uint64_t(hi.z - lo.z + 1);
+        if (rangeCells <= cells_.size()) {
+            for (int32_t z = lo.z; z <= hi.z; ++z) {
+                for (int32_t y = lo.y; y <= hi.y; ++y) {
+                    for (int32_t x = lo.x; x <= hi.x; ++x) {
+                        auto it = cells_.find(cellKey({ x, y, z }));
+                        if (it == cells_.end()) continue;
+                        for (uint32_t index : it->second) fn(index);
+                    }
+                }
+            }
+        } else {
+            for (const auto& [key, cell] : cells_) {
+                math::ivec3 c = cellFromKey(key);
+                if (c.x < lo.x || c.y < lo.y || c.z < lo.z || c.x > hi.x || c.y > hi.y || c.z > hi.z) continue;
+                for (uint32_t index : cell) fn(index);
+            }
         }
-        return result;
+    }
+
+    void GridPartitioner::queryVisible(const jaeng::math::AABB& volume, std::vector<uint32_t>& out) const {
+        out.clear();
+        forEachCandidate(volume, [&](uint32_t index) {
+            if (entries_[index].bounds.intersects(volume)) out.push_back(index);
+        });
+    }
+
+    void GridPartitioner::queryFrustum(const math::Frustum& frustum, std::vector<uint32_t>& out) const {
+        out.clear();
+        // Entries are scattered, so their bounds are copied into a small array per batch
+        FrustumBatch batch(frustum, out, [this](uint32_t index) { return entries_[index].bounds; });
+        forEachCandidate(frustum.bounds, [&](uint32_t index) { batch.add(index); });
     }
 };
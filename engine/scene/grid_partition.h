@@ -7,24 +7,68 @@
 
 namespace jaeng {
 
+    // Uniform grid over a spatial hash: only occupied cells exist, so the world has no fixed extent.
+    // Each proxy lives in the cell holding the center of its bounds; since it may stick out of it by up
+    // to half a cell, queries widen the volume by that much (a "loose" grid), which keeps every proxy in
+    // exactly one cell and makes moves within a cell free. Proxies larger than a cell are kept in a
+    // separate list that every query tests.
     class GridPartitioner : public ISpatialPartitioner {
     public:
+        explicit GridPartitioner(float cellSize = 8.0f);
+
         void addOrUpdate(const RenderProxy& proxy) override;
         void remove(uint32_t id) override;
+        const RenderProxy* find(uint32_t id) const override;
 
-        // Builds the Partition (No Op on this Example)
+        // Nothing to do, cells are updated as proxies move
         void build() override;
 
-        // Clears data and Rebuilds Partition (No Op on this Example)
+        // Shrinks the occupied cell range, which only grows as proxies move
         void rebuild() override;
 
-        // Clears existing partition (No Op on this Example)
+        // Clears existing partition
         void reset() override;
 
-        // Query the drawing Components of entities in the given volume (All entities in this case)
-        std::vector<RenderProxy> queryVisible(const jaeng::math::AABB& volume) const override;
+        // Proxies whose bounds overlap the volume
+        void queryVisible(const jaeng::math::AABB& volume, std::vector<uint32_t>& out) const override;
+
+        // Proxies in the cells under the frustum bounds whose bounds intersect the frustum
+        void queryFrustum(const math::Frustum& frustum, std::vector<uint32_t>& out) const override;
+
+        const RenderProxy& getProxy(uint32_t index) const override { return entries_[index].proxy; }
+
+        float getCellSize() const { return cellSize_; }
+        size_t getCellCount() const { return cells_.size(); }
 
     private:
-        std::unordered_map<uint32_t, RenderProxy> proxies_;
+        using CellKey = uint64_t;
+
+        struct Entry {
+            RenderProxy proxy;
+            math::AABB bounds;
+            CellKey cell;
+            bool oversized;
+            uint32_t slot;  // Position in its cell list (or oversized_)
+        };
+
+        math::ivec3 cellCoord(const math::vec3& p) const;
+        static CellKey cellKey(const math::ivec3& c);
+        static math::ivec3 cellFromKey(CellKey key);
+        bool isOversized(const math::AABB& bounds) const;
+        // Calls fn with the entries_ position of every oversized proxy and of every proxy in a cell
+        // that may overlap the volume
+        template<typename Fn>
+        void forEachCandidate(const math::AABB& volume, Fn&& fn) const;
+        void growOccupied(const math::ivec3& c);
+        void link(uint32_t index);
+        void unlink(uint32_t index);
+
+        float cellSize_;
+        float invCellSize_;
+        std::vector<Entry> entries_;                      // Dense, swap-removed
+        std::unordered_map<uint32_t, uint32_t> index_;    // Proxy id -> entries_ position
+        std::unordered_map<CellKey, std::vector<uint32_t>> cells_;
+        std::vector<uint32_t> oversized_;
+        math::ivec3 minCell_{0}, maxCell_{-1};            // Range covering every occupied cell
     };
 }
@@ -2,6 +2,7 @@
 
 #include "common/math/math.h"
 #include "common/math/aabb.h"
+#include "common/math/frustum.h"
 #include "common/math/conventions.h"
 #include "common/math/ray.h"
 
@@ -13,6 +14,7 @@ public:
 
     virtual jaeng::math::mat4 getViewProj() const = 0;
     virtual math::AABB getViewedVolume() const = 0;
+    virtual math::Frustum getFrustum() const { return math::Frustum::fromViewProj(getViewProj()); }
     virtual math::Ray  getRay(float x, float y) const = 0;
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/math/aabb.h"
+#include "common/math/frustum.h"
 #include "entity/entity.h"
 #include "material/imaterialsys.h"
 #include "mesh/imeshsys.h"
@@ -22,6 +23,8 @@ struct RenderProxy {
     MaterialHandle material;
     BufferHandle constant;
     glm::vec4 color{1.0f};
+    math::AABB bounds{};  // World space: the mesh bounds transformed by worldMatrix, used by the partitioners
+    uint32_t binding = 0; // Render side: the Scene's resolved mesh/material state, set when the proxy is added
 };
 
 struct UIRenderProxy {
@@ -37,16 +40,6 @@ struct UIRenderProxy {
     glm::vec4 clipRect{ 0.0f, 0.0f, -1.0f, -1.0f }; // [x, y, w, h]. w < 0 means no clipping
 };
 
-enum class RenderCommandType { Update, Destroy, UpdateCamera, UpdateUI, DestroyUI, ClearUI };
-
-struct RenderCommand {
-    RenderCommandType type;
-    RenderProxy proxy; // Valid if Update
-    UIRenderProxy uiProxy; // Valid if UpdateUI
-    uint32_t id;       // Valid if Destroy or DestroyUI
-    glm::mat4 cameraViewProj; // Valid if UpdateCamera
-};
-
 // Minimal spatial partitioner interface
 class ISpatialPartitioner {
 public:
@@ -58,6 +51,9 @@ public:
     // Removes an entity from partition
     virtual void remove(uint32_t id) = 0;
 
+    // Returns the stored proxy for an entity, or nullptr if it is not in the partition
+    virtual const RenderProxy* find(uint32_t id) const = 0;
+
     // Builds the Partition
     virtual void build() = 0;
 
@@ -67,8 +63,16 @@ public:
     // Clears existing partition
     virtual void reset() = 0;
 
-    // Query entities contained by given volume (e.g., frustum culling)
-    virtual std::vector<RenderProxy> queryVisible(const jaeng::math::AABB& volume) const = 0;
+    // Query entities whose bounds overlap the volume. Queries fill out with indices for getProxy,
+    // replacing its contents but keeping its capacity, so a buffer reused across frames makes the
+    // query allocation free. Indices are valid until the partition is modified.
+    virtual void queryVisible(const jaeng::math::AABB& volume, std::vector<uint32_t>& out) const = 0;
+
+    // Query entities whose bounds intersect the frustum (camera culling)
+    virtual void queryFrustum(const jaeng::math::Frustum& frustum, std::vector<uint32_t>& out) const = 0;
+
+    // The proxy at an index returned by a query
+    virtual const RenderProxy& getProxy(uint32_t index) const = 0;
 };
 
 } // namespace jaeng
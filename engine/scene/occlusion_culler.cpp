@@ -0,0 +1,205 @@
+#include "occlusion_culler.h"
+#include "common/async/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JAENG_OCCLUSION_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define JAENG_OCCLUSION_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace jaeng {
+    namespace {
+        // Vertices past this many viewport sizes off screen skip their triangle, which keeps the edge
+        // functions precise; skipping an occluder triangle only makes culling more conservative
+        constexpr float kGuardBand = 16.0f;
+        constexpr float kMinArea = 1e-6f;
+    }
+
+    OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height)
+        : tilesX_((std::max(width, 1u) + kTileSize - 1) / kTileSize)
+        , tilesY_((std::max(height, 1u) + kTileSize - 1) / kTileSize)
+    {
+        width_ = tilesX_ * kTileSize;
+        height_ = tilesY_ * kTileSize;
+        depth_.assign(size_t(width_) * height_, 1.0f);
+        tileMax_.assign(size_t(tilesX_) * tilesY_, 1.0f);
+    }
+
+    void OcclusionCuller::begin(const math::mat4& viewProj) {
+        viewProj_ = viewProj;
+        triangles_.clear();
+    }
+
+    void OcclusionCuller::addOccluder(const math::vec3* positions, size_t vertexCount, const uint32_t* indices, size_t indexCount, const math::mat4& world) {
+        math::mat4 toClip = viewProj_ * world;
+        clip_.resize(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i) clip_[i] = toClip * math::vec4(positions[i], 1.0f);
+
+        for (size_t i = 0; i + 2 < indexCount; i += 3) {
+            if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount) continue;
+            setupTriangle(clip_[indices[i]], clip_[indices[i + 1]], clip_[indices[i + 2]]);
+        }
+    }
+
+    void OcclusionCuller::setupTriangle(const math::vec4& v0, const math::vec4& v1, const math::vec4& v2) {
+        const math::vec4* clip[3] = { &v0, &v1, &v2 };
+        float x[3], y[3];
+        Triangle tri;
+        tri.depth = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            const math::vec4& v = *clip[i];
+            // Behind or crossing the near plane
+            if (v.w <= 0.0f || v.z < 0.0f) return;
+            float invW = 1.0f / v.w;
+            float nx = v.x * invW, ny = v.y * invW;
+            if (std::abs(nx) > kGuardBand || std::abs(ny) > kGuardBand) return;
+            x[i] = (nx * 0.5f + 0.5f) * float(width_);
+            y[i] = (0.5f - ny * 0.5f) * float(height_);
+            tri.depth = std::max(tri.depth, v.z * invW);
+        }
+
+        // Edge i runs from vertex i to the next; flip them all for clockwise triangles so the inside
+        // is always where they are positive
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (std::abs(area) < kMinArea) return;
+        float sign = area > 0.0f ? 1.0f : -1.0f;
+        for (int i = 0; i < 3; ++i) {
+            int j = (i + 1) % 3;
+            tri.a[i] = -(y[j] - y[i]) * sign;
+            tri.b[i] = (x[j] - x[i]) * sign;
+            tri.c[i] = ((y[j] - y[i]) * x[i] - (x[j] - x[i]) * y[i]) * sign;
+        }
+
+        tri.minX = std::max(0, int32_t(std::floor(std::min({ x[0], x[1], x[2] }))));
+        tri.maxX = std::min(int32_t(width_) - 1, int32_t(std::ceil(std::max({ x[0], x[1], x[2] }))));
+        tri.minY = std::max(0, int32_t(std::floor(std::min({ y[0], y[1], y[2] }))));
+        tri.maxY = std::min(int32_t(height_) - 1, int32_t(std::ceil(std::max({ y[0], y[1], y[2] }))));
+        if (tri.minX > tri.maxX || tri.minY > tri.maxY) return;
+
+        triangles_.push_back(tri);
+    }
+
+    void OcclusionCuller::rasterize() {
+        async::parallel_for_chunks(tilesY_, 1, [this](size_t, size_t begin, size_t) {
+            rasterizeBand(static_cast<uint32_t>(begin));
+        });
+    }
+
+    void OcclusionCuller::rasterizeBand(uint32_t tileRow) {
+        const int32_t y0 = int32_t(tileRow * kTileSize);
+        const int32_t y1 = y0 + int32_t(kTileSize) - 1;
+        float* band = depth_.data() + size_t(y0) * width_;
+        std::fill(band, band + size_t(kTileSize) * width_, 1.0f);
+
+        for (const Triangle& tri : triangles_) {
+            if (tri.maxY < y0 || tri.minY > y1) continue;
+
+            // Spans start on a multiple of 4 so every SIMD step stays inside the (tile aligned) row
+            const int32_t xStart = tri.minX & ~3;
+            for (int32_t y = std::max(y0, tri.minY); y <= std::min(y1, tri.maxY); ++y) {
+                float* row = depth_.data() + size_t(y) * width_;
+                float py = float(y) + 0.5f;
+                float e[3];
+                for (int i = 0; i < 3; ++i) e[i] = tri.a[i] * (float(xStart) + 0.5f) + tri.b[i] * py + tri.c[i];
+
+                int32_t x = xStart;
+#if JAENG_OCCLUSION_SSE
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 z = _mm_set1_ps(tri.depth);
+                __m128 edge[3], step[3];
+                for (int i = 0; i < 3; ++i) {
+                    edge[i] = _mm_add_ps(_mm_set1_ps(e[i]), _mm_mul_ps(_mm_set1_ps(tri.a[i]), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)));
+                    step[i] = _mm_set1_ps(tri.a[i] * 4.0f);
+                }
+                for (; x <= tri.maxX; x += 4) {
+                    __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge[0], zero), _mm_cmpge_ps(edge[1], zero)), _mm_cmpge_ps(edge[2], zero));
+                    __m128 d = _mm_loadu_ps(row + x);
+                    d = _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(d, z)), _mm_andnot_ps(inside, d));
+                    _mm_storeu_ps(row + x, d);
+                    for (int i = 0; i < 3; ++i) edge[i] = _mm_add_ps(edge[i], step[i]);
+                }
+#elif JAENG_OCCLUSION_NEON
+                const float32x4_t zero = vdupq_n_f32(0.0f);
+                const float32x4_t z = vdupq_n_f32(tri.depth);
+                const float lanes[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+                float32x4_t edge[3], step[3];
+                for (int i = 0; i < 3; ++i) {
+                    edge[i] = vmlaq_f32(vdupq_n_f32(e[i]), vdupq_n_f32(tri.a[i]), vld1q_f32(lanes));
+                    step[i] = vdupq_n_f32(tri.a[i] * 4.0f);
+                }
+                for (; x <= tri.maxX; x += 4) {
+                    uint32x4_t inside = vandq_u32(vandq_u32(vcgeq_f32(edge[0], zero), vcgeq_f32(edge[1], zero)), vcgeq_f32(edge[2], zero));
+                    float32x4_t d = vld1q_f32(row + x);
+                    vst1q_f32(row + x, vbslq_f32(inside, vminq_f32(d, z), d));
+                    for (int i = 0; i < 3; ++i) edge[i] = vaddq_f32(edge[i], step[i]);
+                }
+#else
+                for (; x <= tri.maxX; ++x) {
+                    if (e[0] >= 0.0f && e[1] >= 0.0f && e[2] >= 0.0f) row[x] = std::min(row[x], tri.depth);
+                    for (int i = 0; i < 3; ++i) e[i] += tri.a[i];
+                }
+#endif
+            }
+        }
+
+        for (uint32_t tx = 0; tx < tilesX_; ++tx) {
+            float farthest = 0.0f;
+            for (uint32_t y = 0; y < kTileSize; ++y) {
+                const float* p = band + size_t(y) * width_ + tx * kTileSize;
+                for (uint32_t x = 0; x < kTileSize; ++x) farthest = std::max(farthest, p[x]);
+            }
+            tileMax_[size_t(tileRow) * tilesX_ + tx] = farthest;
+        }
+    }
+
+    bool OcclusionCuller::isVisible(const math::AABB& bounds) const {
+        // Screen rectangle and nearest depth of the box corners
+        float minX = float(width_), maxX = 0.0f, minY = float(height_), maxY = 0.0f, nearest = 1.0f;
+        for (int i = 0; i < 8; ++i) {
+            math::vec4 v = viewProj_ * math::vec4((i & 1) ? bounds.max.x : bounds.min.x,
+                                                  (i & 2) ? bounds.max.y : bounds.min.y,
+                                                  (i & 4) ? bounds.max.z : bounds.min.z, 1.0f);
+            // Reaches the camera plane: nothing can be in front of all of it
+            if (v.w <= 0.0f || v.z < 0.0f) return true;
+            float invW = 1.0f / v.w;
+            float sx = (v.x * invW * 0.5f + 0.5f) * float(width_);
+            float sy = (0.5f - v.y * invW * 0.5f) * float(height_);
+            minX = std::min(minX, sx);
+            maxX = std::max(maxX, sx);
+            minY = std::min(minY, sy);
+            maxY = std::max(maxY, sy);
+            nearest = std::min(nearest, v.z * invW);
+        }
+
+        // Pixels count as covered when the occluder covers their center, so along its silhouette a
+        // pixel can be marked while part of it is not covered. Widening the rectangle by a pixel also
+        // checks the neighbors across such an edge.
+        int32_t x0 = std::max(0, int32_t(std::floor(minX)) - 1);
+        int32_t x1 = std::min(int32_t(width_) - 1, int32_t(std::floor(maxX)) + 1);
+        int32_t y0 = std::max(0, int32_t(std::floor(minY)) - 1);
+        int32_t y1 = std::min(int32_t(height_) - 1, int32_t(std::floor(maxY)) + 1);
+        if (x0 > x1 || y0 > y1) return true;  // Off screen, left to the frustum test
+
+        for (int32_t ty = y0 / int32_t(kTileSize); ty <= y1 / int32_t(kTileSize); ++ty) {
+            for (int32_t tx = x0 / int32_t(kTileSize); tx <= x1 / int32_t(kTileSize); ++tx) {
+                // Every pixel of the tile is nearer than the box
+                if (tileMax_[size_t(ty) * tilesX_ + tx] < nearest) continue;
+
+                int32_t px0 = std::max(x0, tx * int32_t(kTileSize)), px1 = std::min(x1, tx * int32_t(kTileSize) + int32_t(kTileSize) - 1);
+                int32_t py0 = std::max(y0, ty * int32_t(kTileSize)), py1 = std::min(y1, ty * int32_t(kTileSize) + int32_t(kTileSize) - 1);
+                for (int32_t y = py0; y <= py1; ++y) {
+                    const float* row = depth_.data() + size_t(y) * width_;
+                    for (int32_t x = px0; x <= px1; ++x) {
+                        if (row[x] >= nearest) return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "common/math/aabb.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace jaeng {
+
+    // Software occlusion culling, entirely on the CPU so it works with any backend. Occluder meshes are
+    // rasterized into a low resolution depth buffer, each covered pixel taking the farthest depth of the
+    // triangle covering it, so occluders never appear closer than they are. Rows are split into bands
+    // of one tile row, rasterized in parallel on the TaskScheduler workers with 4 pixels per SIMD step,
+    // and each band then stores the farthest depth of its tiles. The calling (render) thread claims
+    // bands too and never waits on workers busy with other queued work, so a worker backlog costs at
+    // most the serial rasterization time. A box is hidden when its projected
+    // rectangle only covers pixels nearer than its nearest point: tiles are checked first and only the
+    // tiles that cannot prove it alone are checked per pixel.
+    //
+    // Occluders must be opaque and solid; triangles crossing the near plane are skipped.
+    class OcclusionCuller {
+    public:
+        static constexpr uint32_t kTileSize = 8;
+
+        // Dimensions are rounded up to whole tiles
+        explicit OcclusionCuller(uint32_t width = 256, uint32_t height = 128);
+
+        // Starts a frame seen through viewProj, dropping the previous occluders
+        void begin(const math::mat4& viewProj);
+
+        // Projects a triangle list occluder and queues its triangles for rasterize()
+        void addOccluder(const math::vec3* positions, size_t vertexCount, const uint32_t* indices, size_t indexCount, const math::mat4& world);
+
+        // Rasterizes the queued occluders and builds the tile depths
+        void rasterize();
+
+        // False when the box is certainly hidden behind the occluders
+        bool isVisible(const math::AABB& bounds) const;
+
+        uint32_t getWidth() const { return width_; }
+        uint32_t getHeight() const { return height_; }
+        size_t getTriangleCount() const { return triangles_.size(); }
+        const std::vector<float>& getDepth() const { return depth_; }
+
+    private:
+        // Screen space triangle. Pixel centers where all three edge functions a*x + b*y + c are
+        // non-negative are covered.
+        struct Triangle {
+            float a[3], b[3], c[3];
+            float depth;
+            int32_t minX, maxX, minY, maxY;
+        };
+
+        void setupTriangle(const math::vec4& v0, const math::vec4& v1, const math::vec4& v2);
+        void rasterizeBand(uint32_t tileRow);
+
+        uint32_t width_;
+        uint32_t height_;
+        uint32_t tilesX_;
+        uint32_t tilesY_;
+        math::mat4 viewProj_{1.0f};
+        std::vector<float> depth_;      // Normalized depth per pixel, 1 (far plane) where nothing was drawn
+        std::vector<float> tileMax_;    // Farthest depth per tile
+        std::vector<Triangle> triangles_;
+        std::vector<math::vec4> clip_;   // Occluder vertices in clip space, reused by addOccluder
+    };
+}
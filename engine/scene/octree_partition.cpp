@@ -0,0 +1,235 @@
+#include "octree_partition.h"
+#include "partition_query.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace jaeng {
+    OctreePartitioner::OctreePartitioner(const math::AABB& world, uint32_t maxDepth)
+        : world_(world)
+        , maxDepth_(std::min(maxDepth, 20u))
+    {
+        initRoot();
+    }
+
+    void OctreePartitioner::initRoot() {
+        nodes_.clear();
+        freeBlocks_.clear();
+        math::vec3 extents = world_.extents();
+        nodes_.push_back({ world_.center(), std::max(extents.x, std::max(extents.y, extents.z)), 0, kNull, kNull, 0, {} });
+    }
+
+    int32_t OctreePartitioner::allocChildren(int32_t parent) {
+        int32_t first;
+        if (!freeBlocks_.empty()) {
+            first = freeBlocks_.back();
+            freeBlocks_.pop_back();
+        } else {
+            first = static_cast<int32_t>(nodes_.size());
+            nodes_.resize(nodes_.size() + 8);
+        }
+
+        // Child i sits on the positive side of axis a when bit a of i is set
+        math::vec3 center = nodes_[parent].center;
+        float half = nodes_[parent].halfSize * 0.5f;
+        for (int32_t i = 0; i < 8; ++i) {
+            Node& child = nodes_[first + i];
+            child.center = center + math::vec3((i & 1) ? half : -half, (i & 2) ? half : -half, (i & 4) ? half : -half);
+            child.halfSize = half;
+            child.depth = nodes_[parent].depth + 1;
+            child.parent = parent;
+            child.children = kNull;
+            child.subtreeCount = 0;
+            child.items.clear();
+        }
+        nodes_[parent].children = first;
+        return first;
+    }
+
+    void OctreePartitioner::freeChildren(int32_t node) {
+        int32_t first = nodes_[node].children;
+        if (first == kNull) return;
+        for (int32_t i = 0; i < 8; ++i) freeChildren(first + i);
+        nodes_[node].children = kNull;
+        freeBlocks_.push_back(first);
+    }
+
+    bool OctreePartitioner::insideRoot(const math::vec3& p) const {
+        math::vec3 d = p - nodes_[0].center;
+        float h = nodes_[0].halfSize;
+        return std::abs(d.x) <= h && std::abs(d.y) <= h && std::abs(d.z) <= h;
+    }
+
+    uint32_t OctreePartitioner::targetDepth(const math::AABB& bounds) const {
+        if (!insideRoot(bounds.center())) return 0;
+
+        // Go down while the proxy still fits the children's loose bounds (twice their half size)
+        math::vec3 ext = bounds.extents();
+        float radius = std::max(ext.x, std::max(ext.y, ext.z));
+        uint32_t depth = 0;
+        for (float half = nodes_[0].halfSize * 0.5f; depth < maxDepth_ && radius <= half; half *= 0.5f) ++depth;
+        return depth;
+    }
+
+    int32_t OctreePartitioner::targetNode(const math::AABB& bounds) {
+        math::vec3 center = bounds.center();
+        uint32_t depth = targetDepth(bounds);
+
+        int32_t node = 0;
+        for (uint32_t d = 0; d < depth; ++d) {
+            int32_t first = nodes_[node].children;
+            if (first == kNull) first = allocChildren(node);
+            const math::vec3& c = nodes_[node].center;
+            node = first + (center.x >= c.x ? 1 : 0) + (center.y >= c.y ? 2 : 0) + (center.z >= c.z ? 4 : 0);
+        }
+        return node;
+    }
+
+    void OctreePartitioner::link(uint32_t entry, int32_t node, const math::AABB& bounds) {
+        entries_[entry].node = node;
+        entries_[entry].slot = static_cast<uint32_t>(nodes_[node].items.size());
+        nodes_[node].items.push_back({ bounds, entry });
+        for (int32_t n = node; n != kNull; n = nodes_[n].parent) ++nodes_[n].subtreeCount;
+    }
+
+    void OctreePartitioner::unlink(uint32_t entry) {
+        int32_t node = entries_[entry].node;
+        auto& items = nodes_[node].items;
+        uint32_t slot = entries_[entry].slot;
+        items[slot] = items.back();
+        entries_[items[slot].entry].slot = slot;
+        items.pop_back();
+
+        // Return the children of the highest subtree that became empty to the pool
+        int32_t emptied = kNull;
+        for (int32_t n = node; n != kNull; n = nodes_[n].parent) {
+            if (--nodes_[n].subtreeCount == 0) emptied = n;
+        }
+        if (emptied != kNull) freeChildren(emptied);
+    }
+
+    void OctreePartitioner::addOrUpdate(const RenderProxy& proxy) {
+        math::AABB bounds = proxy.bounds;
+
+        auto [it, inserted] = index_.try_emplace(proxy.id, static_cast<uint32_t>(entries_.size()));
+        if (inserted) {
+            entries_.push_back({ proxy, kNull, 0 });
+            link(it->second, targetNode(bounds), bounds);
+            return;
+        }
+
+        uint32_t index = it->second;
+        entries_[index].proxy = proxy;
+
+        // Still the deepest fitting node, and the center did not leave its cell: just update the bounds
+        int32_t current = entries_[index].node;
+        const Node& node = nodes_[current];
+        math::vec3 d = bounds.center() - node.center;
+        bool inCell = current == 0 || (std::abs(d.x) < node.halfSize && std::abs(d.y) < node.halfSize && std::abs(d.z) < node.halfSize);
+        if (inCell && targetDepth(bounds) == node.depth) {
+            nodes_[current].items[entries_[index].slot].bounds = bounds;
+            return;
+        }
+
+        // Unlink first so an emptied branch can be reused by the new path
+        unlink(index);
+        link(index, targetNode(bounds), bounds);
+    }
+
+    void OctreePartitioner::remove(uint32_t id) {
+        auto it = index_.find(id);
+        if (it == index_.end()) return;
+        uint32_t index = it->second;
+        index_.erase(it);
+        unlink(index);
+
+        uint32_t last = static_cast<uint32_t>(entries_.size() - 1);
+        if (index != last) {
+            entries_[index] = std::move(entries_[last]);
+            nodes_[entries_[index].node].items[entries_[index].slot].entry = index;
+            index_[entries_[index].proxy.id] = index;
+        }
+        entries_.pop_back();
+    }
+
+    const RenderProxy* OctreePartitioner::find(uint32_t id) const {
+        auto it = index_.find(id);
+        return it != index_.end() ? &entries_[it->second].proxy : nullptr;
+    }
+
+    void OctreePartitioner::build() {}
+
+    void OctreePartitioner::rebuild() {
+        std::vector<math::AABB> bounds(entries_.size());
+        for (uint32_t i = 0; i < entries_.size(); ++i) {
+            bounds[i] = nodes_[entries_[i].node].items[entries_[i].slot].bounds;
+        }
+        initRoot();
+        for (uint32_t i = 0; i < entries_.size(); ++i) link(i, targetNode(bounds[i]), bounds[i]);
+    }
+
+    void OctreePartitioner::reset() {
+        entries_.clear();
+        index_.clear();
+        initRoot();
+    }
+
+    void OctreePartitioner::queryVisible(const jaeng::math::AABB& volume, std::vector<uint32_t>& out) const {
+        out.clear();
+
+        // Every visited node pushes its 8 children, so the stack never holds more than 7 per level
+        QueryStack<int32_t> stack(7 * maxDepth_ + 1);
+        stack.push(0);
+        while (!stack.empty()) {
+            const Node& node = nodes_[stack.pop()];
+            if (node.subtreeCount == 0) continue;
+            // The root also holds proxies outside the world volume
+            if (node.parent != kNull && !node.looseBounds().intersects(volume)) continue;
+
+            for (const Item& item : node.items) {
+                if (item.bounds.intersects(volume)) out.push_back(item.entry);
+            }
+            if (node.children != kNull) {
+                for (int32_t i = 0; i < 8; ++i) stack.push(node.children + i);
+            }
+        }
+    }
+
+    void OctreePartitioner::queryFrustum(const math::Frustum& frustum, std::vector<uint32_t>& out) const {
+        out.clear();
+
+        // The low bit marks subtrees already known to be fully inside
+        constexpr size_t kBatch = 64;
+        uint8_t visible[kBatch];
+        QueryStack<int32_t> stack(7 * maxDepth_ + 1);
+        stack.push(0);
+        while (!stack.empty()) {
+            int32_t top = stack.pop();
+            const Node& node = nodes_[top >> 1];
+            bool inside = top & 1;
+            if (node.subtreeCount == 0) continue;
+
+            if (!inside && node.parent != kNull) {
+                auto side = frustum.classify(node.looseBounds());
+                if (side == math::Frustum::Result::Outside) continue;
+                inside = side == math::Frustum::Result::Inside;
+            }
+
+            if (inside) {
+                for (const Item& item : node.items) out.push_back(item.entry);
+            } else {
+                // Items are tested where they are, a batch at a time
+                for (size_t first = 0; first < node.items.size(); first += kBatch) {
+                    size_t count = (std::min)(kBatch, node.items.size() - first);
+                    frustum.cull(&node.items[first].bounds, count, visible, sizeof(Item));
+                    for (size_t i = 0; i < count; ++i) {
+                        if (visible[i]) out.push_back(node.items[first + i].entry);
+                    }
+                }
+            }
+            if (node.children != kNull) {
+                for (int32_t i = 0; i < 8; ++i) stack.push(((node.children + i) << 1) | int32_t(inside));
+            }
+        }
+    }
+};
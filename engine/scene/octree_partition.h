@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ipartition.h"
+#include <unordered_map>
+
+namespace jaeng {
+
+    // Loose octree over a fixed world volume. Every node's bounds are doubled for containment, so a
+    // proxy only has to fit by size: it goes to the deepest node whose half size is at least its
+    // largest half extent, found by descending towards its center. Moves within that node only update
+    // the stored bounds. Children are allocated as blocks of 8 contiguous nodes from a pool and
+    // returned to it when their subtree empties; each node keeps its proxies' bounds in one array, so
+    // culling a node reads contiguous memory. Queries skip empty subtrees and reject whole subtrees
+    // against the volume or frustum, and subtrees fully inside the frustum skip the plane tests.
+    // Proxies outside the (cubic) world volume are kept in the root.
+    class OctreePartitioner : public ISpatialPartitioner {
+    public:
+        explicit OctreePartitioner(const math::AABB& world = { {-4096.0f, -4096.0f, -4096.0f}, {4096.0f, 4096.0f, 4096.0f} }, uint32_t maxDepth = 8);
+
+        void addOrUpdate(const RenderProxy& proxy) override;
+        void remove(uint32_t id) override;
+        const RenderProxy* find(uint32_t id) const override;
+
+        // Nothing to do, nodes are updated as proxies move
+        void build() override;
+
+        // Reinserts every proxy into a fresh tree
+        void rebuild() override;
+
+        // Clears existing partition
+        void reset() override;
+
+        // Proxies whose bounds overlap the volume
+        void queryVisible(const jaeng::math::AABB& volume, std::vector<uint32_t>& out) const override;
+
+        // Proxies whose bounds intersect the frustum; each node's items are tested in batches
+        void queryFrustum(const math::Frustum& frustum, std::vector<uint32_t>& out) const override;
+
+        const RenderProxy& getProxy(uint32_t index) const override { return entries_[index].proxy; }
+
+        size_t getNodeCount() const { return nodes_.size() - freeBlocks_.size() * 8; }
+
+    private:
+        static constexpr int32_t kNull = -1;
+
+        struct Item {
+            math::AABB bounds;
+            uint32_t entry;
+        };
+
+        struct Node {
+            math::vec3 center;
+            float halfSize;
+            uint32_t depth;
+            int32_t parent;
+            int32_t children;        // First of 8 contiguous nodes, or kNull
+            uint32_t subtreeCount;   // Proxies in this node and below
+            std::vector<Item> items;
+
+            math::AABB looseBounds() const { return { center - math::vec3(2.0f * halfSize), center + math::vec3(2.0f * halfSize) }; }
+        };
+
+        struct Entry {
+            RenderProxy proxy;
+            int32_t node;
+            uint32_t slot;  // Position in the node's items
+        };
+
+        bool insideRoot(const math::vec3& p) const;
+        uint32_t targetDepth(const math::AABB& bounds) const;
+        int32_t targetNode(const math::AABB& bounds);
+        int32_t allocChildren(int32_t parent);
+        void freeChildren(int32_t node);
+        void link(uint32_t entry, int32_t node, const math::AABB& bounds);
+        void unlink(uint32_t entry);
+        void initRoot();
+
+        math::AABB world_;
+        uint32_t maxDepth_;
+        std::vector<Node> nodes_;                         // nodes_[0] is the root
+        std::vector<int32_t> freeBlocks_;
+        std::vector<Entry> entries_;                      // Dense, swap-removed
+        std::unordered_map<uint32_t, uint32_t> index_;    // Proxy id -> entries_ position
+    };
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common/math/frustum.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Building blocks shared by the partitioner queries. Both keep their storage on the stack, so a
+// query neither allocates nor needs per-partitioner scratch (queries stay safe to run concurrently).
+
+namespace jaeng {
+
+    // Traversal stack with inline storage. The capacity is the most entries the traversal can hold at
+    // once (e.g. tree height + 1 for a binary tree); only capacities past kInline allocate.
+    template<typename T, size_t kInline = 128>
+    class QueryStack {
+    public:
+        explicit QueryStack(size_t capacity) {
+            if (capacity > kInline) {
+                heap_.resize(capacity);
+                data_ = heap_.data();
+            }
+        }
+
+        void push(T value) { data_[size_++] = value; }
+        T pop() { return data_[--size_]; }
+        bool empty() const { return size_ == 0; }
+
+    private:
+        T inline_[kInline];
+        std::vector<T> heap_;
+        T* data_ = inline_;
+        size_t size_ = 0;
+    };
+
+    // Gathers candidate entries and tests their bounds against the frustum in batches (Frustum::cull),
+    // appending the visible ones to out. boundsOf(index) returns the bounds of an entry.
+    template<typename BoundsOf>
+    class FrustumBatch {
+    public:
+        static constexpr size_t kBatch = 64;
+
+        FrustumBatch(const math::Frustum& frustum, std::vector<uint32_t>& out, BoundsOf boundsOf)
+            : frustum_(frustum), out_(out), boundsOf_(boundsOf) {}
+        ~FrustumBatch() { flush(); }
+
+        void add(uint32_t index) {
+            indices_[count_] = index;
+            boxes_[count_] = boundsOf_(index);
+            if (++count_ == kBatch) flush();
+        }
+
+        void flush() {
+            if (count_ == 0) return;
+            frustum_.cull(boxes_, count_, visible_);
+            for (size_t i = 0; i < count_; ++i) {
+                if (visible_[i]) out_.push_back(indices_[i]);
+            }
+            count_ = 0;
+        }
+
+    private:
+        const math::Frustum& frustum_;
+        std::vector<uint32_t>& out_;
+        BoundsOf boundsOf_;
+        math::AABB boxes_[kBatch];
+        uint32_t indices_[kBatch];
+        uint8_t visible_[kBatch];
+        size_t count_ = 0;
+    };
+}
@@ -45,7 +45,7 @@ jaeng::math::mat4 PerspectiveCamera::getViewProj() const
 
 math::AABB PerspectiveCamera::getViewedVolume() const
 {
-    return {};
+    return math::AABB::fromViewProj(getViewProj());
 }
 
 math::Ray PerspectiveCamera::getRay(float x, float y) const
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "scene/ipartition.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace jaeng {
+
+// Reset drops every 3D proxy on the render side; the Updates following it are a full snapshot
+enum class RenderCommandType : uint8_t { Update, Destroy, UpdateCamera, UpdateUI, DestroyUI, ClearUI, Reset };
+
+// Variable-length, tagged command stream written by the Sim thread and replayed by the Render thread.
+// Each record is an 8 byte header followed by only the payload its type needs, packed into a linear
+// arena that keeps its capacity across frames, so steady-state extraction does not allocate.
+//
+// Extraction is delta based, so a stream may cover several sim frames: when the render thread skips
+// a published stream, the next frame is appended to it instead of replacing it. The sequence range
+// lets the render side detect gaps, and needsSnapshot() tells extractors to emit full state.
+class RenderCommandStream {
+    static constexpr size_t kAlignment = 8;
+    static constexpr size_t kHeaderSize = 8;
+
+    struct Header {
+        RenderCommandType type;
+        uint8_t reserved[3];
+        uint32_t size; // Whole record, header included
+    };
+    static_assert(sizeof(Header) == kHeaderSize);
+
+public:
+    // A record as seen while iterating; the accessor matching type() is the only valid one
+    class Command {
+    public:
+        RenderCommandType type() const { return header_->type; }
+
+        const RenderProxy& proxy() const { return payload<RenderProxy>(); }          // Update
+        const UIRenderProxy& uiProxy() const { return payload<UIRenderProxy>(); }    // UpdateUI
+        uint32_t id() const { return payload<uint32_t>(); }                          // Destroy, DestroyUI
+        const glm::mat4& cameraViewProj() const { return payload<glm::mat4>(); }     // UpdateCamera
+
+    private:
+        friend class RenderCommandStream;
+        explicit Command(const std::byte* record) : header_(reinterpret_cast<const Header*>(record)) {}
+
+        template<typename T>
+        const T& payload() const {
+            return *std::launder(reinterpret_cast<const T*>(reinterpret_cast<const std::byte*>(header_) + kHeaderSize));
+        }
+
+        const Header* header_;
+    };
+
+    class Iterator {
+    public:
+        using value_type = Command;
+        using difference_type = std::ptrdiff_t;
+
+        Command operator*() const { return Command(cursor_); }
+        Iterator& operator++() {
+            cursor_ += reinterpret_cast<const Header*>(cursor_)->size;
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return cursor_ == other.cursor_; }
+
+    private:
+        friend class RenderCommandStream;
+        explicit Iterator(const std::byte* cursor) : cursor_(cursor) {}
+        const std::byte* cursor_;
+    };
+
+    RenderCommandStream() = default;
+    RenderCommandStream(RenderCommandStream&&) noexcept = default;
+    RenderCommandStream& operator=(RenderCommandStream&&) noexcept = default;
+
+    // Emitters. The returned reference stays valid until the next emit.
+    RenderProxy& pushUpdate(const RenderProxy& proxy) { return emit(RenderCommandType::Update, proxy); }
+    UIRenderProxy& pushUpdateUI(const UIRenderProxy& proxy) { return emit(RenderCommandType::UpdateUI, proxy); }
+    void pushDestroy(uint32_t id) { emit(RenderCommandType::Destroy, id); }
+    void pushDestroyUI(uint32_t id) { emit(RenderCommandType::DestroyUI, id); }
+    void pushCamera(const glm::mat4& viewProj) { emit(RenderCommandType::UpdateCamera, viewProj); }
+    void pushClearUI() { emitHeader(RenderCommandType::ClearUI, 0); }
+    void pushReset() { emitHeader(RenderCommandType::Reset, 0); }
+
+    // Marks the sim frame being appended. The first frame of a stream sets firstSequence().
+    // simTime is the simulated time (seconds) after the frame's last tick; the wall clock time of the
+    // call is recorded with it so the render side can interpolate between streams.
+    void beginFrame(uint64_t sequence, double simTime = 0.0) {
+        if (firstSequence_ == 0) firstSequence_ = sequence;
+        lastSequence_ = sequence;
+        simTime_ = simTime;
+        frameTime_ = std::chrono::steady_clock::now();
+    }
+    uint64_t firstSequence() const { return firstSequence_; }
+    uint64_t sequence() const { return lastSequence_; }
+    double simTime() const { return simTime_; }
+    std::chrono::steady_clock::time_point frameTime() const { return frameTime_; }
+
+    // Appends every record of another stream, e.g. a per-worker chunk, after the ones already here
+    void append(const RenderCommandStream& other) {
+        if (other.size_ == 0) return;
+        if (size_ + other.size_ > capacity_) grow(size_ + other.size_);
+        std::memcpy(data_.get() + size_, other.data_.get(), other.size_);
+        size_ += other.size_;
+        count_ += other.count_;
+    }
+
+    // Drops all records but keeps the arena
+    void clear() {
+        size_ = 0;
+        count_ = 0;
+        firstSequence_ = 0;
+        lastSequence_ = 0;
+        needsSnapshot_ = false;
+    }
+
+    // Drops records that were never delivered; extractors must emit full state for this stream
+    void discard() {
+        clear();
+        needsSnapshot_ = true;
+    }
+    bool needsSnapshot() const { return needsSnapshot_; }
+
+    bool empty() const { return count_ == 0; }
+    size_t commandCount() const { return count_; }
+    size_t byteSize() const { return size_; }
+
+    Iterator begin() const { return Iterator(data_.get()); }
+    Iterator end() const { return Iterator(data_.get() + size_); }
+
+private:
+    static constexpr size_t alignUp(size_t n) { return (n + kAlignment - 1) & ~(kAlignment - 1); }
+
+    template<typename T>
+    T& emit(RenderCommandType type, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= kAlignment);
+        std::byte* record = emitHeader(type, sizeof(T));
+        return *new (record + kHeaderSize) T(value);
+    }
+
+    std::byte* emitHeader(RenderCommandType type, size_t payloadSize);
+    void grow(size_t minCapacity);
+
+    std::unique_ptr<std::byte[]> data_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    size_t count_ = 0;
+    uint64_t firstSequence_ = 0;
+    uint64_t lastSequence_ = 0;
+    double simTime_ = 0.0;
+    std::chrono::steady_clock::time_point frameTime_;
+    bool needsSnapshot_ = false;
+};
+
+inline std::byte* RenderCommandStream::emitHeader(RenderCommandType type, size_t payloadSize) {
+    size_t recordSize = alignUp(kHeaderSize + payloadSize);
+    if (size_ + recordSize > capacity_) grow(size_ + recordSize);
+
+    std::byte* record = data_.get() + size_;
+    new (record) Header{type, {}, static_cast<uint32_t>(recordSize)};
+    size_ += recordSize;
+    ++count_;
+    return record;
+}
+
+inline void RenderCommandStream::grow(size_t minCapacity) {
+    size_t capacity = capacity_ ? capacity_ * 2 : 16 * 1024;
+    while (capacity < minCapacity) capacity *= 2;
+
+    // operator new[] alignment covers kAlignment
+    std::unique_ptr<std::byte[]> data(new std::byte[capacity]);
+    if (size_) std::memcpy(data.get(), data_.get(), size_);
+    data_ = std::move(data);
+    capacity_ = capacity;
+}
+
+} // namespace jaeng
@@ -1,32 +1,80 @@
 #include "render_sys.h"
 #include "entity/transform_sys.h"
+#include "common/async/parallel.h"
 
 #include "scene.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace jaeng {
 
-void SceneRenderSystem::extract(Scene& scene, EntityManager& ecs, std::vector<RenderCommand>& outCommands, 
+void SceneRenderSystem::extract(Scene& scene, EntityManager& ecs, RenderCommandStream& outCommands, 
                                 std::function<void(EntityID, RenderProxy&)> visitor,
                                 const math::AABB* volume) {
-    const auto& entities = ecs.getAllEntities<WorldMatrix>();
-    
-    for (auto e : entities) {
-        auto* wm = ecs.getComponent<WorldMatrix>(e);
-        auto* mesh = ecs.getComponent<MeshComponent>(e);
-        auto* mat = ecs.getComponent<MaterialComponent>(e);
-        auto* cb = ecs.getComponent<BufferComponent>(e);
-
-        if (wm && mesh && mat) {
+    auto& cache = scene.getExtractCache();
+
+    // Resync on the first pass, when the stream lost undelivered deltas, or when the render side saw a gap
+    bool resync = scene.consumeResyncRequest();
+    if (!cache.primed || outCommands.needsSnapshot() || resync) {
+        cache.clear();
+        cache.primed = true;
+        outCommands.pushReset();
+    }
+
+    const uint64_t pass = ++cache.pass;
+
+    // Resolve pools up front: workers must not touch the pool map
+    auto& worldPool = ecs.getComponentPool<WorldMatrix>();
+    auto& meshPool = ecs.getComponentPool<MeshComponent>();
+    auto& matPool = ecs.getComponentPool<MaterialComponent>();
+    auto& bufferPool = ecs.getComponentPool<BufferComponent>();
+    const auto& entities = worldPool.getAllEntities();
+    auto meshSys = scene.getMeshSystem();
+
+    // Size the cache for every id so chunks only write their own entries
+    if (!entities.empty()) {
+        EntityID maxId = *std::max_element(entities.begin(), entities.end());
+        if (maxId >= cache.entries.size()) cache.entries.resize(maxId + 1);
+    }
+
+    size_t chunkCount = (entities.size() + kChunkSize - 1) / kChunkSize;
+    if (cache.chunks.size() < chunkCount) cache.chunks.resize(chunkCount);
+
+    async::parallel_for_chunks(entities.size(), kChunkSize, [&](size_t chunkIndex, size_t begin, size_t end) {
+        auto& chunk = cache.chunks[chunkIndex];
+        chunk.commands.clear();
+        chunk.added.clear();
+        chunk.meshBounds.clear();
+
+        // Meshes are shared by many entities, so each chunk asks the mesh system once per mesh
+        auto localBounds = [&](MeshHandle handle) -> const math::AABB* {
+            auto it = chunk.meshBounds.find(handle);
+            if (it == chunk.meshBounds.end()) {
+                if (!meshSys) return nullptr;
+                auto res = meshSys->getMesh(handle);
+                if (!res.hasValue()) return nullptr;
+                it = chunk.meshBounds.emplace(handle, std::move(res).logError().value()->bounds).first;
+            }
+            return &it->second;
+        };
+
+        for (size_t i = begin; i < end; ++i) {
+            EntityID e = entities[i];
+            auto* wm = worldPool.find(e);
+            auto* mesh = meshPool.find(e);
+            auto* mat = matPool.find(e);
+            auto* cb = bufferPool.find(e);
+
+            if (!(wm && mesh && mat)) continue;
+
             // Optional spatial filtering
             if (volume) {
                 glm::vec3 pos = glm::vec3(wm->value[3]);
                 if (!volume->contains(pos)) continue;
             }
 
-            RenderCommand cmd;
-            cmd.type = RenderCommandType::Update;
-            
-            cmd.proxy = RenderProxy { 
+            RenderProxy proxy { 
                 static_cast<uint32_t>(e), 
                 wm->value, 
                 mesh->handle, 
@@ -35,13 +83,48 @@ void SceneRenderSystem::extract(Scene& scene, EntityManager& ecs, std::vector<Re
                 glm::vec4(1.0f) // default color
             };
 
-            // Allow the visitor to modify the proxy before queuing
+            // Allow the visitor to modify the proxy before it is compared and queued
             if (visitor) {
-                visitor(e, cmd.proxy);
+                visitor(e, proxy);
             }
 
-            outCommands.push_back(cmd);
+            if (auto* local = localBounds(proxy.mesh)) {
+                proxy.bounds = local->transformed(proxy.worldMatrix);
+            } else {
+                math::vec3 position(proxy.worldMatrix[3]);
+                proxy.bounds = { position, position };
+            }
+
+            auto& entry = cache.entries[e];
+            bool known = entry.lastSeen != 0;
+            entry.lastSeen = pass;
+
+            // Bitwise compare: any transform, mesh, material, buffer, color or bounds change re-sends the proxy
+            if (known && std::memcmp(&entry.proxy, &proxy, sizeof(RenderProxy)) == 0) continue;
+
+            entry.proxy = proxy;
+            if (!known) chunk.added.push_back(e);
+            chunk.commands.pushUpdate(proxy);
+        }
+    });
+
+    // Merge in chunk order so the stream does not depend on scheduling
+    for (size_t c = 0; c < chunkCount; ++c) {
+        outCommands.append(cache.chunks[c].commands);
+        cache.live.insert(cache.live.end(), cache.chunks[c].added.begin(), cache.chunks[c].added.end());
+    }
+
+    // Whatever was not produced this pass was destroyed, lost a component or left the volume
+    for (size_t i = 0; i < cache.live.size();) {
+        EntityID e = cache.live[i];
+        if (cache.entries[e].lastSeen == pass) {
+            ++i;
+            continue;
         }
+        cache.entries[e].lastSeen = 0;
+        outCommands.pushDestroy(static_cast<uint32_t>(e));
+        cache.live[i] = cache.live.back();
+        cache.live.pop_back();
     }
 }
 
@@ -1,15 +1,45 @@
 #pragma once
 
 #include "entity/entity.h"
-#include "scene/ipartition.h"
+#include "scene/render_commands.h"
 #include <vector>
 #include <functional>
+#include <unordered_map>
 #include "common/math/math.h"
 
 namespace jaeng {
 
 class Scene;
 
+/**
+ * @brief Sim-thread copy of the proxies the render side currently holds, used to emit only deltas.
+ */
+struct RenderExtractCache {
+    struct Entry {
+        RenderProxy proxy;
+        uint64_t lastSeen = 0; // Extraction pass that last produced this entity, 0 if not live
+    };
+
+    std::vector<Entry> entries;   // Indexed by EntityID
+    std::vector<EntityID> live;   // Entities the render side knows about
+    uint64_t pass = 0;
+    bool primed = false;          // False until a full snapshot was emitted
+
+    // Per-chunk outputs of parallel extraction, kept to reuse their arenas
+    struct Chunk {
+        RenderCommandStream commands;
+        std::vector<EntityID> added;
+        std::unordered_map<MeshHandle, math::AABB> meshBounds;  // Local bounds looked up this pass
+    };
+    std::vector<Chunk> chunks;
+
+    void clear() {
+        entries.clear();
+        live.clear();
+        primed = false;
+    }
+};
+
 /**
  * @brief System responsible for extracting low-level RenderProxies from high-level ECS components.
  */
@@ -18,15 +48,29 @@ public:
     /**
      * @brief Gathers entities with WorldMatrix, MeshComponent, and MaterialComponent into the provided render queue.
      * 
+     * Only entities whose proxy changed since the last extraction emit an Update, entities that
+     * disappeared emit a Destroy. A full snapshot (Reset + every proxy) is emitted on the first call,
+     * when the stream asks for one, or when the scene reported a sequence gap.
+     * 
+     * Entities are processed in chunks on the TaskScheduler workers; the chunk outputs are appended
+     * in chunk order, so the result is the same as a serial pass. The visitor is called from worker
+     * threads and must be safe to call concurrently.
+     * 
+     * Proxy bounds are the mesh's local bounds transformed by the (visitor adjusted) world matrix;
+     * until the mesh is loaded they collapse to the entity's position.
+     * 
      * @param scene The scene context for extraction.
      * @param ecs The entity manager to query.
-     * @param outCommands The output command queue.
+     * @param outCommands The output command stream.
      * @param visitor Optional callback to visit and modify each generated proxy before queuing.
      * @param volume Optional volume to filter entities by position.
      */
-    static void extract(Scene& scene, EntityManager& ecs, std::vector<RenderCommand>& outCommands, 
+    static void extract(Scene& scene, EntityManager& ecs, RenderCommandStream& outCommands, 
                         std::function<void(EntityID, RenderProxy&)> visitor = nullptr,
                         const math::AABB* volume = nullptr);
+
+    // Entities per extraction chunk
+    static constexpr size_t kChunkSize = 2048;
 };
 
 } // namespace jaeng
@@ -1,4 +1,7 @@
 #include "scene.h"
+#include "grid_partition.h"
+#include "bvh_partition.h"
+#include "octree_partition.h"
 
 #include "common/math/math.h"
 #define GLM_ENABLE_EXPERIMENTAL
@@ -19,11 +22,212 @@ Scene::Scene(const std::string& name, std::unique_ptr<ISpatialPartitioner> parti
     , renderer(r)
 {}
 
+// Blends two world matrices as translation/rotation/scale, so a rotating proxy keeps its shape
+// between snapshots instead of shrinking as a plain component-wise lerp would make it
+static math::mat4 interpolateWorld(const math::mat4& from, const math::mat4& to, float t)
+{
+    math::vec3 fromScale(math::length(math::vec3(from[0])), math::length(math::vec3(from[1])), math::length(math::vec3(from[2])));
+    math::vec3 toScale(math::length(math::vec3(to[0])), math::length(math::vec3(to[1])), math::length(math::vec3(to[2])));
+    if (fromScale.x * fromScale.y * fromScale.z < 1e-12f || toScale.x * toScale.y * toScale.z < 1e-12f) return to;
+
+    math::mat3 fromRot(math::vec3(from[0]) / fromScale.x, math::vec3(from[1]) / fromScale.y, math::vec3(from[2]) / fromScale.z);
+    math::mat3 toRot(math::vec3(to[0]) / toScale.x, math::vec3(to[1]) / toScale.y, math::vec3(to[2]) / toScale.z);
+
+    // Mirrored bases have no rotation quaternion, snap instead
+    if (math::dot(math::cross(fromRot[0], fromRot[1]), fromRot[2]) < 0.0f ||
+        math::dot(math::cross(toRot[0], toRot[1]), toRot[2]) < 0.0f) {
+        return to;
+    }
+
+    math::quat rotation = math::slerp(math::quat_cast(fromRot), math::quat_cast(toRot), t);
+    math::vec3 scale = math::mix(fromScale, toScale, t);
+
+    math::mat4 result = math::toMat4(rotation);
+    result[0] *= scale.x;
+    result[1] *= scale.y;
+    result[2] *= scale.z;
+    result[3] = math::vec4(math::mix(math::vec3(from[3]), math::vec3(to[3]), t), 1.0f);
+    return result;
+}
+
+float Scene::computeInterpolationAlpha() const
+{
+    double interval = currentSimTime - previousSimTime;
+    if (interval <= 0.0) return 1.0f;
+
+    // The latest stream was published one sim interval after the previous one; render it fully once
+    // that much wall time has passed since it arrived
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - currentFrameTime).count();
+    return static_cast<float>(std::clamp(elapsed / interval, 0.0, 1.0));
+}
+
+math::mat4 Scene::frameViewProj() const
+{
+    if (!interpolation || frameAlpha >= 1.0f) return cachedViewProj;
+    math::mat4 viewProj;
+    for (int c = 0; c < 4; ++c) viewProj[c] = math::mix(previousViewProj[c], cachedViewProj[c], frameAlpha);
+    return viewProj;
+}
+
+void Scene::buildDrawList()
+{
+    // Culls against the camera the frame is drawn with, blended while interpolating. Proxies are
+    // tested at their latest bounds, not at the blended transform they are drawn with.
+    frameAlpha = interpolation ? computeInterpolationAlpha() : 1.0f;
+    partitioner->queryFrustum(math::Frustum::fromViewProj(frameViewProj()), visibleProxies);
+    fillDrawList();
+}
+
+void Scene::buildDrawList(const math::Frustum& frustum)
+{
+    frameAlpha = interpolation ? computeInterpolationAlpha() : 1.0f;
+    partitioner->queryFrustum(frustum, visibleProxies);
+    fillDrawList();
+}
+
 void Scene::buildDrawList(const math::AABB& volume)
+{
+    frameAlpha = interpolation ? computeInterpolationAlpha() : 1.0f;
+    partitioner->queryVisible(volume, visibleProxies);
+    fillDrawList();
+}
+
+void Scene::setOcclusionCulling(bool enabled)
+{
+    if (!enabled) occlusion.reset();
+    else if (!occlusion) occlusion = std::make_unique<OcclusionCuller>();
+}
+
+void Scene::cullOccluded()
+{
+    // Occluders are drawn at their latest transform, like the bounds they are tested against
+    occlusion->begin(frameViewProj());
+    for (uint32_t index : visibleProxies) {
+        const RenderProxy& proxy = partitioner->getProxy(index);
+        const Mesh* mesh = bindings[proxy.binding].occluder;
+        if (!mesh) continue;
+        occlusion->addOccluder(mesh->occluderPositions.data(), mesh->occluderPositions.size(),
+                               mesh->occluderIndices.data(), mesh->occluderIndices.size(), proxy.worldMatrix);
+    }
+    if (occlusion->getTriangleCount() == 0) return;
+
+    occlusion->rasterize();
+    std::erase_if(visibleProxies, [this](uint32_t index) {
+        return !occlusion->isVisible(partitioner->getProxy(index).bounds);
+    });
+}
+
+void Scene::addOrUpdateProxy(const RenderProxy& proxy)
+{
+    RenderProxy bound = proxy;
+    bound.binding = bindingFor(proxy.mesh, proxy.material);
+    partitioner->addOrUpdate(bound);
+}
+
+uint32_t Scene::bindingFor(MeshHandle mesh, MaterialHandle material)
+{
+    auto [it, inserted] = bindingIndex.try_emplace((uint64_t(mesh) << 32) | material, static_cast<uint32_t>(bindings.size()));
+    if (inserted) bindings.push_back({ .mesh = mesh, .material = material });
+    return it->second;
+}
+
+void Scene::resolveBinding(DrawBinding& binding, IMeshSystem& meshSystem, IMaterialSystem& matSystem)
+{
+    binding = DrawBinding{ .mesh = binding.mesh, .material = binding.material };
+
+    auto meshRes = meshSystem.getMesh(binding.mesh);
+    auto matBgRes = matSystem.getBindData(binding.material);
+    if (!meshRes.hasValue() || !matBgRes.hasValue()) return;
+
+    auto* mesh = std::move(meshRes).logError().value();
+    auto* matBg = std::move(matBgRes).logError().value();
+
+    // Safety: Ensure shaders and layout are valid handles
+    if (matBg->vertexShader == 0 || matBg->pixelShader == 0 || matBg->vertexLayout == 0) return;
+
+    // Blending comes from the material and decides the draw order
+    auto metaRes = matSystem.getMetadata(binding.material);
+    const MaterialMetadata* meta = metaRes.hasValue() ? std::move(metaRes).logError().value() : nullptr;
+    binding.blended = meta && meta->blendState.enabled;
+
+    // Creates or Retrieves the Pipeline
+    PipelineCache::Key pk { .material = binding.material, .topology = mesh->topology, .enableBlend = binding.blended };
+    auto pso = pipelineCache->getPipeline(pk);
+    if (!pso.has_value()) {
+        auto gfx = renderer.lock();
+        if (!gfx) return;
+
+        // Creates Pipeline and Stores it in the cache
+        GraphicsPipelineDesc pdesc{matBg->vertexShader, matBg->pixelShader, mesh->topology, matBg->vertexLayout, TextureFormat::BGRA8_UNORM};
+
+        // Get DepthStencil from Material
+        if (meta) {
+            pdesc.depth_stencil.enableDepth = meta->depthStencil.depthTest;
+            pdesc.depth_stencil.depthWrite = meta->depthStencil.depthWrite;
+            pdesc.depth_stencil.depthFunc = DepthStencilOptions::DepthFunc::LessEqual;
+        } else {
+            pdesc.depth_stencil.enableDepth = true; // fallback
+        }
+
+        pdesc.enable_blend = binding.blended;
+        auto newPso = gfx->create_graphics_pipeline(&pdesc);
+        if (newPso == 0) return; // Skip if pipeline creation failed
+        pso = newPso;
+        pipelineCache->storePipeline(pk, *pso);
+    }
+
+    if (*pso == 0) return;
+
+    binding.pipeline = *pso;
+    binding.vertexBuffer = mesh->vertexBuffer;
+    binding.indexBuffer = mesh->indexBuffer;
+    binding.indexCount = static_cast<uint32_t>(mesh->indexCount);
+    if (!mesh->occluderIndices.empty()) binding.occluder = mesh;
+
+    if (matBg->constantBuffers.size() > 0) binding.cbFrame = matBg->constantBuffers[0];
+    if (matBg->constantBuffers.size() > 1) binding.constant = matBg->constantBuffers[1];
+    // In case shader expects material constant buffer
+    if (matBg->constantBuffers.size() >= 3) binding.objectConstant = matBg->constantBuffers[2];
+    if (!matBg->textureIndices.empty()) binding.textureIndex = matBg->textureIndices[0];
+    if (!matBg->samplerIndices.empty()) binding.samplerIndex = matBg->samplerIndices[0];
+
+    // Instancing is opt in: the material's shader must declare the per-object buffer the draws upload
+    // to (objectConstant when the material has one, CBObject otherwise) as an InstanceData array
+    if (meta && meta->maxInstances > 1) {
+        size_t bound = binding.objectConstant != 0 ? 2 : 1;
+        uint32_t cbSize = meta->constantBuffers.size() > bound ? meta->constantBuffers[bound].size : 0;
+        if (cbSize % sizeof(InstanceData) != 0 || cbSize / sizeof(InstanceData) < meta->maxInstances) {
+            JAENG_LOG_ERROR("[Scene] Material '{}' sets maxInstances {} but its per-object buffer (constant buffer {}, {} bytes) is not an array of that many {} byte InstanceData, drawing it one instance at a time",
+                            meta->name, meta->maxInstances, bound, cbSize, sizeof(InstanceData));
+        } else if (meta->maxInstances > kMaxInstancesPerDraw) {
+            JAENG_LOG_WARN("[Scene] Material '{}' sets maxInstances {}, one draw binds at most {}", meta->name, meta->maxInstances, kMaxInstancesPerDraw);
+            binding.instanceCapacity = kMaxInstancesPerDraw;
+        } else {
+            binding.instanceCapacity = meta->maxInstances;
+        }
+    }
+    binding.valid = true;
+}
+
+void Scene::appendDraw(std::vector<DrawBatch>& batches, std::vector<DrawPacket>& packets, const DrawBatch& state, DrawPacket&& packet)
+{
+    if (batches.empty() || !batches.back().sharesState(state)) {
+        DrawBatch& batch = batches.emplace_back(state);
+        batch.firstPacket = static_cast<uint32_t>(packets.size());
+        batch.packetCount = 0;
+    }
+    ++batches.back().packetCount;
+    packets.push_back(std::move(packet));
+}
+
+void Scene::fillDrawList()
 {
     // Clears the list (if any system is not available, no point in keeping it)
     drawList.clear();
+    drawPackets.clear();
+    drawInstances.clear();
     uiDrawList.clear();
+    uiDrawPackets.clear();
 
     // Retrieve the reference to Mesh and Material Systems
     auto meshSystem = meshSys.lock();
@@ -37,75 +241,70 @@ void Scene::buildDrawList(const math::AABB& volume)
         return;
     }
 
-    // Collect the ComponentPack of all entities in the volume and iterate
-    auto proxies = partitioner->queryVisible(volume);
-    for (auto& proxy : proxies) {
-        auto meshRes = meshSystem->getMesh(proxy.mesh);
-        auto matBgRes = matSystem->getBindData(proxy.material);
+    // Loads, reloads and removals in either system bump its generation; re-resolve every pair then,
+    // otherwise only the ones added since the last frame
+    uint64_t meshGen = meshSystem->getGeneration();
+    uint64_t matGen = matSystem->getGeneration();
+    if (meshGen != meshGeneration || matGen != materialGeneration) {
+        meshGeneration = meshGen;
+        materialGeneration = matGen;
+        resolvedBindings = 0;
+    }
+    for (; resolvedBindings < bindings.size(); ++resolvedBindings) {
+        resolveBinding(bindings[resolvedBindings], *meshSystem, *matSystem);
+    }
 
-        if (!meshRes.hasValue() || !matBgRes.hasValue()) continue;
-        
-        auto* mesh = std::move(meshRes).logError().value();
-        auto* matBg = std::move(matBgRes).logError().value();
+    if (occlusion) cullOccluded();
 
-        // Safety: Ensure shaders and layout are valid handles
-        if (matBg->vertexShader == 0 || matBg->pixelShader == 0 || matBg->vertexLayout == 0) continue;
+    pendingPackets.clear();
+    pendingStates.clear();
+    drawKeys.clear();
+    const math::mat4 viewProj = frameViewProj();
 
-        // Creates or Retrieves the Pipeline
-        PipelineCache::Key pk { .material = proxy.material, .topology = mesh->topology, .enableBlend = false };
-        auto pso = pipelineCache->getPipeline(pk);
-        if (!pso.has_value()) {
-            auto gfx = renderer.lock();
-            if (!gfx) return; 
-            
-            // Creates Pipeline and Stores it in the cache
-            GraphicsPipelineDesc pdesc{matBg->vertexShader, matBg->pixelShader, mesh->topology, matBg->vertexLayout, TextureFormat::BGRA8_UNORM};
-            
-            // Get DepthStencil from Material
-            auto metaRes = matSystem->getMetadata(proxy.material);
-            if (metaRes.hasValue()) {
-                auto meta = std::move(metaRes).logError().value();
-                pdesc.depth_stencil.enableDepth = meta->depthStencil.depthTest;
-                pdesc.depth_stencil.depthWrite = meta->depthStencil.depthWrite;
-                pdesc.depth_stencil.depthFunc = DepthStencilOptions::DepthFunc::LessEqual;
-            } else {
-                pdesc.depth_stencil.enableDepth = true; // fallback
-            }
+    for (uint32_t index : visibleProxies) {
+        const RenderProxy& proxy = partitioner->getProxy(index);
+        const DrawBinding& binding = bindings[proxy.binding];
+        if (!binding.valid) continue;
 
-            pdesc.enable_blend = false;
-            auto newPso = gfx->create_graphics_pipeline(&pdesc);
-            if (newPso == 0) continue; // Skip if pipeline creation failed
-            pso = newPso;
-            pipelineCache->storePipeline(pk, *pso);
+        // Only proxies moved by the latest stream have a previous transform to blend from
+        math::mat4 world = proxy.worldMatrix;
+        if (frameAlpha < 1.0f) {
+            auto motionIt = motion.find(proxy.id);
+            if (motionIt != motion.end() && motionIt->second.sequence == lastAppliedSequence) {
+                world = interpolateWorld(motionIt->second.previous, proxy.worldMatrix, frameAlpha);
+            }
         }
 
-        if (*pso == 0) continue;
-
-        // TODO: Sort data in a way that shared pipeline and group bindings are grouped together in the same DrawBatch
         DrawPacket dp{.entityId = static_cast<int>(proxy.id),
-                      .worldMatrix  = proxy.worldMatrix,
+                      .worldMatrix  = world,
                       .color = proxy.color,
-                      .vertexBuffer = mesh->vertexBuffer,
-                      .indexBuffer  = mesh->indexBuffer,
-                      .indexCount   = static_cast<uint32_t>(mesh->indexCount),
-                      .constant     = proxy.constant
+                      .vertexBuffer = binding.vertexBuffer,
+                      .indexBuffer  = binding.indexBuffer,
+                      .indexCount   = binding.indexCount,
+                      .constant     = proxy.constant ? proxy.constant : binding.objectConstant
                       };
-        // In case shader expects material constant buffer
-        if (matBg->constantBuffers.size() >= 3 && dp.constant == 0) {
-            dp.constant = matBg->constantBuffers[2];
-        }
 
-        DrawBatch db { .pipeline = *pso, .material = proxy.material };
-        if (matBg->constantBuffers.size() > 0) {
-            db.cbFrame = matBg->constantBuffers[0];
-        }
-        if (matBg->constantBuffers.size() > 1) {
-            db.constant = matBg->constantBuffers[1];
-        }
-        db.packets.push_back(std::move(dp));
+        // A proxy's own constant buffer only holds itself
+        DrawBatch db { .pipeline = binding.pipeline, .material = proxy.material, .constant = binding.constant, .cbFrame = binding.cbFrame,
+                       .instanceCapacity = proxy.constant ? 1u : binding.instanceCapacity,
+                       .textureIndex = binding.textureIndex, .samplerIndex = binding.samplerIndex };
+
+        // Sorted by the depth of the bounds center
+        math::vec4 clip = viewProj * math::vec4(proxy.bounds.center(), 1.0f);
+        float depth = clip.w > 0.0f ? clip.z / clip.w : 0.0f;
+        uint64_t key = binding.blended ? makeBlendedDrawKey(binding.pipeline, proxy.material, proxy.mesh, depth)
+                                       : makeOpaqueDrawKey(binding.pipeline, proxy.material, proxy.mesh, depth);
+        drawKeys.push_back({ key, static_cast<uint32_t>(pendingPackets.size()) });
+        pendingPackets.push_back(std::move(dp));
+        pendingStates.push_back(db);
+    }
 
-        // Store the Batch on the DrawList
-        drawList.push_back(std::move(db));
+    // Consecutive draws sharing their state end up in the same batch
+    radixSortDraws(drawKeys, drawKeysScratch);
+    for (const DrawSortItem& item : drawKeys) {
+        const DrawPacket& dp = pendingPackets[item.index];
+        drawInstances.push_back({ dp.worldMatrix, dp.color, dp.uvRect });
+        appendDraw(drawList, drawPackets, pendingStates[item.index], std::move(pendingPackets[item.index]));
     }
 
     // Process UI Proxies
@@ -176,29 +375,51 @@ void Scene::buildDrawList(const math::AABB& volume)
         if (matBg->constantBuffers.size() > 1) {
             db.constant = matBg->constantBuffers[1];
         }
-        db.packets.push_back(std::move(dp));
-
-        uiDrawList.push_back(std::move(db));
+        if (!matBg->textureIndices.empty()) db.textureIndex = matBg->textureIndices[0];
+        if (!matBg->samplerIndices.empty()) db.samplerIndex = matBg->samplerIndices[0];
+        appendDraw(uiDrawList, uiDrawPackets, db, std::move(dp));
     }
 }
 
-void Scene::processCommands(const std::vector<RenderCommand>& queue) {
-    for (const auto& cmd : queue) {
-        switch (cmd.type) {
+void Scene::processCommands(const RenderCommandStream& stream) {
+    bool gap = stream.firstSequence() != 0 && stream.firstSequence() != lastAppliedSequence + 1;
+    bool snapshot = false;
+    if (interpolation) previousViewProj = cachedViewProj;
+
+    for (auto cmd : stream) {
+        switch (cmd.type()) {
+            case RenderCommandType::Reset:
+                partitioner->reset();
+                bindings.clear();
+                bindingIndex.clear();
+                resolvedBindings = 0;
+                motion.clear();
+                snapshot = true;
+                break;
             case RenderCommandType::Update:
-                addOrUpdateProxy(cmd.proxy);
+                if (interpolation) {
+                    // Remember the transform from before this stream (a merged stream may update twice)
+                    const RenderProxy& proxy = cmd.proxy();
+                    auto [it, inserted] = motion.try_emplace(proxy.id);
+                    if (inserted || it->second.sequence != stream.sequence()) {
+                        const RenderProxy* current = partitioner->find(proxy.id);
+                        it->second = { current ? current->worldMatrix : proxy.worldMatrix, stream.sequence() };
+                    }
+                }
+                addOrUpdateProxy(cmd.proxy());
                 break;
             case RenderCommandType::Destroy:
-                removeProxy(cmd.id);
+                removeProxy(cmd.id());
+                motion.erase(cmd.id());
                 break;
             case RenderCommandType::UpdateCamera:
-                setCameraViewProj(cmd.cameraViewProj);
+                setCameraViewProj(cmd.cameraViewProj());
                 break;
             case RenderCommandType::UpdateUI:
-                addOrUpdateUIProxy(cmd.uiProxy);
+                addOrUpdateUIProxy(cmd.uiProxy());
                 break;
             case RenderCommandType::DestroyUI:
-                removeUIProxy(cmd.id);
+                removeUIProxy(cmd.id());
                 break;
             case RenderCommandType::ClearUI:
                 clearUIProxies();
@@ -206,6 +427,20 @@ void Scene::processCommands(const std::vector<RenderCommand>& queue) {
         }
     }
     partitioner->build();
+
+    if (stream.sequence() != 0) {
+        // Deltas went missing, the proxies may be stale until extraction sends a snapshot
+        if (gap && !snapshot) {
+            JAENG_LOG_WARN("[Scene] '{}' missed render state {}..{}, requesting resync", name, lastAppliedSequence + 1, stream.firstSequence() - 1);
+            resyncRequested.store(true, std::memory_order_release);
+        }
+        lastAppliedSequence = stream.sequence();
+
+        // A snapshot or a gap has no meaningful previous state to blend from
+        previousSimTime = (gap || snapshot) ? stream.simTime() : currentSimTime;
+        currentSimTime = stream.simTime();
+        currentFrameTime = stream.frameTime();
+    }
 }
 
 void Scene::renderScene(RenderGraph& rg, TextureHandle backbuffer, TextureHandle depthBuffer, uint32_t width, uint32_t height, float scaleX, float scaleY)
@@ -219,45 +454,67 @@ void Scene::renderScene(RenderGraph& rg, TextureHandle backbuffer, TextureHandle
     // 2) Forward pass
     rg.add_pass("Forward", 
         { { .tex = backbuffer } }, { .tex = depthBuffer },
-        [&](const RGPassContext& ctx) {
-            auto matSysRef = matSys.lock();
-            if (!matSysRef) return;
+        [&, viewProj = frameViewProj()](const RGPassContext& ctx) {
+            // Batches come sorted by state, so only what differs from the previous draw is sent.
+            // Switching pipelines resets the root bindings on some backends (and the vertex stride
+            // on D3D12), so everything is sent again after one.
+            PipelineHandle boundPipeline = 0;
+            BufferHandle boundFrame = 0, boundVertices = 0, boundIndices = 0;
+            uint32_t pushed[2] = { 0, 0 };
+            bool hasPushed = false;
 
             for (auto& db : drawList) {
-                ctx.gfx->cmd_set_pipeline(ctx.cmd, db.pipeline);
+                if (db.pipeline != boundPipeline) {
+                    ctx.gfx->cmd_set_pipeline(ctx.cmd, db.pipeline);
+                    boundPipeline = db.pipeline;
+                    boundFrame = boundVertices = boundIndices = 0;
+                    hasPushed = false;
+                }
 
-                if (db.cbFrame) {
-                    ctx.gfx->update_buffer(db.cbFrame, 0, &cachedViewProj, sizeof(jaeng::math::mat4));
+                if (db.cbFrame && db.cbFrame != boundFrame) {
+                    ctx.gfx->update_buffer(db.cbFrame, 0, &viewProj, sizeof(jaeng::math::mat4));
                     ctx.gfx->cmd_bind_uniform(ctx.cmd, 0, db.cbFrame, 0);
+                    boundFrame = db.cbFrame;
                 }
 
-                auto matBgRes = matSysRef->getBindData(db.material);
-                if (!matBgRes.hasValue()) continue;
-                auto* matBg = std::move(matBgRes).logError().value();
+                for (uint32_t p = 0; p < db.packetCount;) {
+                    const DrawPacket& dp = drawPackets[db.firstPacket + p];
 
-                for (auto& dp : db.packets) {
-                    ctx.gfx->cmd_set_vertex_buffer(ctx.cmd, 0, dp.vertexBuffer, 0);
-                    ctx.gfx->cmd_set_index_buffer(ctx.cmd, dp.indexBuffer, true, 0);
+                    // The packets after it drawing the same mesh the same way become its instances
+                    uint32_t instances = 1;
+                    while (p + instances < db.packetCount && instances < db.instanceCapacity) {
+                        const DrawPacket& next = drawPackets[db.firstPacket + p + instances];
+                        if (next.vertexBuffer != dp.vertexBuffer || next.indexBuffer != dp.indexBuffer || next.indexCount != dp.indexCount ||
+                            next.constant != dp.constant || next.textureOverride != dp.textureOverride) break;
+                        ++instances;
+                    }
+
+                    if (dp.vertexBuffer != boundVertices) {
+                        ctx.gfx->cmd_set_vertex_buffer(ctx.cmd, 0, dp.vertexBuffer, 0);
+                        boundVertices = dp.vertexBuffer;
+                    }
+                    if (dp.indexBuffer != boundIndices) {
+                        ctx.gfx->cmd_set_index_buffer(ctx.cmd, dp.indexBuffer, true, 0);
+                        boundIndices = dp.indexBuffer;
+                    }
 
                     // Push Bindless Indices (Texture and Sampler)
-                    if (matBg) {
-                        uint32_t indices[2] = { 0, 0 };
-                        if (dp.textureOverride != 0) {
-                            indices[0] = ctx.gfx->get_texture_index(dp.textureOverride);
-                        } else if (!matBg->textureIndices.empty()) {
-                            indices[0] = matBg->textureIndices[0];
-                        }
-                        if (!matBg->samplerIndices.empty()) indices[1] = matBg->samplerIndices[0];
+                    uint32_t indices[2] = { db.textureIndex, db.samplerIndex };
+                    if (dp.textureOverride != 0) indices[0] = ctx.gfx->get_texture_index(dp.textureOverride);
+                    if (!hasPushed || indices[0] != pushed[0] || indices[1] != pushed[1]) {
                         ctx.gfx->cmd_push_constants(ctx.cmd, 0, 2, indices);
+                        pushed[0] = indices[0];
+                        pushed[1] = indices[1];
+                        hasPushed = true;
                     }
                     
-                    // Unified update for WorldMatrix + Color + UVRect
-                    struct { jaeng::math::mat4 w; jaeng::math::vec4 c; jaeng::math::vec4 uv; } cbData { dp.worldMatrix, dp.color, dp.uvRect };
+                    // Unified update for WorldMatrix + Color + UVRect of every instance, read by SV_InstanceID
                     auto cbToBind = (dp.constant != 0) ? dp.constant : db.constant;
-                    ctx.gfx->update_buffer(cbToBind, 0, &cbData, sizeof(cbData));
+                    ctx.gfx->update_buffer(cbToBind, 0, &drawInstances[db.firstPacket + p], instances * sizeof(InstanceData));
                     ctx.gfx->cmd_bind_uniform(ctx.cmd, 1, cbToBind, 0);
 
-                    ctx.gfx->cmd_draw_indexed(ctx.cmd, dp.indexCount, 1, 0, 0, 0);
+                    ctx.gfx->cmd_draw_indexed(ctx.cmd, dp.indexCount, instances, 0, 0, 0);
+                    p += instances;
                 }
             }
         }
@@ -267,9 +524,6 @@ void Scene::renderScene(RenderGraph& rg, TextureHandle backbuffer, TextureHandle
     rg.add_pass("UI_Pass", 
         { { .tex = backbuffer } }, { .tex = 0 },
         [&, width, height, scaleX, scaleY](const RGPassContext& ctx) {
-            auto matSysRef = matSys.lock();
-            if (!matSysRef) return;
-
             // Simple ortho matrix using dynamic viewport dimensions.
             jaeng::math::mat4 orthoProj = jaeng::math::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f, -1.0f, 1.0f);
 
@@ -281,26 +535,16 @@ void Scene::renderScene(RenderGraph& rg, TextureHandle backbuffer, TextureHandle
                     ctx.gfx->cmd_bind_uniform(ctx.cmd, 0, db.cbFrame, 0);
                 }
 
-                auto matBgRes = matSysRef->getBindData(db.material);
-                if (!matBgRes.hasValue()) continue;
-                auto* matBg = std::move(matBgRes).logError().value();
-
-                for (auto& dp : db.packets) {
+                for (uint32_t p = 0; p < db.packetCount; ++p) {
+                    const DrawPacket& dp = uiDrawPackets[db.firstPacket + p];
                     ctx.gfx->cmd_set_vertex_buffer(ctx.cmd, 0, dp.vertexBuffer, 0);
                     ctx.gfx->cmd_set_index_buffer(ctx.cmd, dp.indexBuffer, true, 0);
 
-                    if (matBg) {
-                        uint32_t indices[2] = { 0, 0 };
-                        if (dp.textureOverride != 0) {
-                            indices[0] = ctx.gfx->get_texture_index(dp.textureOverride);
-                        } else if (!matBg->textureIndices.empty()) {
-                            indices[0] = matBg->textureIndices[0];
-                        }
-                        if (!matBg->samplerIndices.empty()) indices[1] = matBg->samplerIndices[0];
-                        ctx.gfx->cmd_push_constants(ctx.cmd, 0, 2, indices);
-                    }
+                    uint32_t indices[2] = { db.textureIndex, db.samplerIndex };
+                    if (dp.textureOverride != 0) indices[0] = ctx.gfx->get_texture_index(dp.textureOverride);
+                    ctx.gfx->cmd_push_constants(ctx.cmd, 0, 2, indices);
                     
-                    struct { jaeng::math::mat4 w; jaeng::math::vec4 c; jaeng::math::vec4 uv; } cbData { dp.worldMatrix, dp.color, dp.uvRect };
+                    InstanceData cbData { dp.worldMatrix, dp.color, dp.uvRect };
                     auto cbToBind = (dp.constant != 0) ? dp.constant : db.constant;
                     ctx.gfx->update_buffer(cbToBind, 0, &cbData, sizeof(cbData));
                     ctx.gfx->cmd_bind_uniform(ctx.cmd, 1, cbToBind, 0);
@@ -345,10 +589,20 @@ SceneManager::SceneManager(std::shared_ptr<IMeshSystem> mes, std::shared_ptr<IMa
 jaeng::result<Scene*> SceneManager::createScene(const std::string& name, std::unique_ptr<ISpatialPartitioner> partitioner, std::unique_ptr<ICamera> camera) {
     JAENG_ERROR_IF(!partitioner || !camera, jaeng::error_code::invalid_args, "[Scene Manager] A Camera and Partitioner is required for a scene");
     auto scene = std::make_unique<Scene>(name, std::move(partitioner), std::move(camera), pipelineCache.get(), meshSys, matSys, renderer);
+    scene->setInterpolation(interpolation);
     scenes[name] = std::move(scene);
     return scenes[name].get();
 }
 
+jaeng::result<Scene*> SceneManager::createScene(const std::string& name, PartitionerType partitioner, std::unique_ptr<ICamera> camera) {
+    switch (partitioner) {
+        case PartitionerType::Grid:   return createScene(name, std::make_unique<GridPartitioner>(), std::move(camera));
+        case PartitionerType::Bvh:    return createScene(name, std::make_unique<BvhPartitioner>(), std::move(camera));
+        case PartitionerType::Octree: return createScene(name, std::make_unique<OctreePartitioner>(), std::move(camera));
+    }
+    JAENG_ERROR(jaeng::error_code::invalid_args, "[Scene Manager] Unknown partitioner type");
+}
+
 void SceneManager::destroyScene(const std::string& name) {
     scenes.erase(name);
 }
@@ -358,4 +612,9 @@ Scene* SceneManager::getScene(const std::string& name) {
     return (it != scenes.end()) ? it->second.get() : nullptr;
 }
 
+void SceneManager::setInterpolation(bool enabled) {
+    interpolation = enabled;
+    for (auto& [name, scene] : scenes) scene->setInterpolation(enabled);
+}
+
 } // namespace jaeng
@@ -5,8 +5,14 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <atomic>
+#include <chrono>
 
 #include "ipartition.h"
+#include "occlusion_culler.h"
+#include "draw_sort.h"
+#include "render_commands.h"
+#include "render_sys.h"
 #include "icamera.h"
 #include "pipelinecache.h"
 #include "render/public/renderer_api.h"
@@ -28,19 +34,27 @@ public:
     const std::string& getName() const { return name; }
 
     // Accept state updates from the command queue
-    void addOrUpdateProxy(const RenderProxy& proxy) { partitioner->addOrUpdate(proxy); }
+    void addOrUpdateProxy(const RenderProxy& proxy);
     void removeProxy(uint32_t id) { partitioner->remove(id); }
     void addOrUpdateUIProxy(const UIRenderProxy& proxy) { uiProxies[proxy.id] = proxy; }
     void removeUIProxy(uint32_t id) { uiProxies.erase(id); }
     void clearUIProxies() { uiProxies.clear(); }
 
-    // Builts batched draw commands for Render Graph
+    // Builts batched draw commands for Render Graph, from the proxies the last received camera sees
+    void buildDrawList();
+    // Same for the proxies intersecting the given frustum or volume
+    void buildDrawList(const math::Frustum&);
     void buildDrawList(const math::AABB&);
 
     void setCbFrame(BufferHandle h) { cbFrame = h; }
 
-    // Consumes a queue of render commands to update the scene state
-    void processCommands(const std::vector<RenderCommand>& queue);
+    // Consumes a queue of render commands to update the scene state.
+    // Requests a resync from extraction if the stream does not continue the last one applied.
+    void processCommands(const RenderCommandStream& stream);
+
+    // Sim thread: delta extraction state, and whether the render side asked for a full snapshot
+    RenderExtractCache& getExtractCache() { return extractCache; }
+    bool consumeResyncRequest() { return resyncRequested.exchange(false, std::memory_order_acq_rel); }
 
     // Creates the needed passes on Render Graph
     void renderScene(RenderGraph& rg, TextureHandle backbuffer, TextureHandle depthBuffer, uint32_t width, uint32_t height, float scaleX = 1.0f, float scaleY = 1.0f);
@@ -48,10 +62,24 @@ public:
     // Access partitioner for queries
     ISpatialPartitioner* getPartitioner() const { return partitioner.get(); }
 
+    // Mesh system the scene draws with, nullptr once it is gone
+    std::shared_ptr<IMeshSystem> getMeshSystem() const { return meshSys.lock(); }
+
     // Access camera
     ICamera* getCamera() const { return camera.get(); }
     void setCameraViewProj(const glm::mat4& vp) { cachedViewProj = vp; }
 
+    // Render-side interpolation: draws blend each moved proxy (and the camera) between the last two
+    // applied streams, based on how far wall time has advanced into the latest sim interval.
+    // Costs one sim interval of latency, lets the render rate exceed the tick rate without stutter.
+    void setInterpolation(bool enabled) { interpolation = enabled; }
+    bool isInterpolating() const { return interpolation; }
+
+    // Software occlusion culling after the partitioner query: visible proxies whose mesh was imported
+    // as an occluder (MeshImportDesc::occluder) hide the ones fully behind them. Off by default.
+    void setOcclusionCulling(bool enabled);
+    bool isOcclusionCulling() const { return occlusion != nullptr; }
+
 private:
     std::string name;
     
@@ -59,10 +87,57 @@ private:
     std::unique_ptr<ISpatialPartitioner> partitioner;
     std::unordered_map<uint32_t, UIRenderProxy> uiProxies;
 
+    // Extraction side (Sim thread) and the sequence the render side applied last
+    RenderExtractCache extractCache;
+    uint64_t lastAppliedSequence = 0;
+    std::atomic<bool> resyncRequested = false;
+
     // Camera for the scene
     std::unique_ptr<ICamera> camera;
     glm::mat4 cachedViewProj{1.0f};
 
+    // Interpolation state (Render thread): world matrix before the stream that last moved a proxy
+    struct MotionState {
+        glm::mat4 previous;
+        uint64_t sequence;
+    };
+    bool interpolation = false;
+    float frameAlpha = 1.0f;
+    std::unordered_map<uint32_t, MotionState> motion;
+    glm::mat4 previousViewProj{1.0f};
+    double previousSimTime = 0.0;
+    double currentSimTime = 0.0;
+    std::chrono::steady_clock::time_point currentFrameTime;
+
+    float computeInterpolationAlpha() const;
+    glm::mat4 frameViewProj() const;
+    void fillDrawList();
+    void cullOccluded();
+
+    // Mesh and material state shared by the proxies drawing the same pair. Looked up when a proxy is
+    // added or updated and resolved again only when either system reports a change (getGeneration),
+    // so building the draw list does no lookups.
+    struct DrawBinding {
+        MeshHandle mesh = 0;
+        MaterialHandle material = 0;
+        bool valid = false;   // Both were found and a pipeline exists
+        bool blended = false;
+        const Mesh* occluder = nullptr; // Set when the mesh was imported as an occluder
+        PipelineHandle pipeline = 0;
+        BufferHandle vertexBuffer = 0;
+        BufferHandle indexBuffer = 0;
+        uint32_t indexCount = 0;
+        BufferHandle cbFrame = 0;
+        BufferHandle constant = 0;
+        BufferHandle objectConstant = 0; // Material's own object constants, for proxies without one
+        uint32_t textureIndex = 0;
+        uint32_t samplerIndex = 0;
+        uint32_t instanceCapacity = 1;
+    };
+
+    uint32_t bindingFor(MeshHandle mesh, MaterialHandle material);
+    void resolveBinding(DrawBinding& binding, IMeshSystem& meshSystem, IMaterialSystem& matSystem);
+
     // Per-Instance Resources for Drawing
     struct DrawPacket {
         int entityId;
@@ -77,18 +152,62 @@ private:
         glm::vec4 clipRect{0.0f, 0.0f, -1.0f, -1.0f}; // Scissor rect
     };
 
-    // Shared Instance Resources for Drawing
+    // Per-instance constants (CBObject), an array of them when the shader draws instanced
+    struct InstanceData {
+        glm::mat4 world;
+        glm::vec4 color;
+        glm::vec4 uvRect;
+    };
+    static_assert(sizeof(InstanceData) == 96, "InstanceData must match CBObject in the shaders");
+    // Instances one draw may use: Vulkan binds a 4 KB window of its uniform ring
+    static constexpr uint32_t kMaxInstancesPerDraw = 4096 / sizeof(InstanceData);
+
+    // Shared Instance Resources for Drawing, used by packets [firstPacket, firstPacket + packetCount)
     struct DrawBatch {
         PipelineHandle pipeline;
         MaterialHandle material;
         BufferHandle   constant; // general uniform
         BufferHandle   cbFrame;
-        std::vector<DrawPacket> packets;
+        uint32_t instanceCapacity = 1; // Instances one draw packs, from the material's maxInstances
+        uint32_t textureIndex = 0;     // Bindless indices of the material's first texture and sampler
+        uint32_t samplerIndex = 0;
+        uint32_t firstPacket = 0;
+        uint32_t packetCount = 0;
+
+        bool sharesState(const DrawBatch& other) const {
+            return pipeline == other.pipeline && material == other.material && constant == other.constant && cbFrame == other.cbFrame &&
+                   instanceCapacity == other.instanceCapacity;
+        }
     };
 
-    // Draw List created for Frame (follows latest build command)
+    // Appends the packet, extending the last batch when it has the same state
+    static void appendDraw(std::vector<DrawBatch>& batches, std::vector<DrawPacket>& packets, const DrawBatch& state, DrawPacket&& packet);
+
+    // Resolved state of every mesh/material pair used since the last reset, RenderProxy::binding
+    // indexes it. Entries past resolvedBindings were added since the last resolve, and a change in
+    // either system's generation resolves them all again.
+    std::vector<DrawBinding> bindings;
+    std::unordered_map<uint64_t, uint32_t> bindingIndex;
+    size_t resolvedBindings = 0;
+    uint64_t meshGeneration = 0;
+    uint64_t materialGeneration = 0;
+
+    // Partitioner query results of the current frame, reused across frames
+    std::vector<uint32_t> visibleProxies;
+    std::unique_ptr<OcclusionCuller> occlusion;
+
+    // Draws of the frame before sorting, with their sort keys (see draw_sort.h), reused across frames
+    std::vector<DrawPacket> pendingPackets;
+    std::vector<DrawBatch> pendingStates;
+    std::vector<DrawSortItem> drawKeys;
+    std::vector<DrawSortItem> drawKeysScratch;
+
+    // Draw List created for Frame (follows latest build command), batches in draw order
     std::vector<DrawBatch> drawList;
+    std::vector<DrawPacket> drawPackets;
+    std::vector<InstanceData> drawInstances; // Constants of drawPackets[i], packed for instanced uploads
     std::vector<DrawBatch> uiDrawList;
+    std::vector<DrawPacket> uiDrawPackets;
     BufferHandle cbFrame = 0;
     PipelineCache* pipelineCache;
     std::weak_ptr<IMeshSystem> meshSys;
@@ -96,23 +215,36 @@ private:
     std::weak_ptr<RendererAPI> renderer;
 };
 
+// Built-in spatial partitioners, see createScene
+enum class PartitionerType {
+    Grid,    // Loose uniform grid, cheapest updates, for evenly spread content
+    Bvh,     // Dynamic AABB tree, for very uneven density
+    Octree   // Loose octree, for large open worlds with dense clusters
+};
+
 // Orchestrates multiple scenes
 class SceneManager {
 public:
     SceneManager(std::shared_ptr<IMeshSystem>, std::shared_ptr<IMaterialSystem>, std::shared_ptr<RendererAPI>);
 
     jaeng::result<Scene*> createScene(const std::string& name, std::unique_ptr<ISpatialPartitioner> partitioner, std::unique_ptr<ICamera> camera);
+    // Creates the scene with a default configured built-in partitioner
+    jaeng::result<Scene*> createScene(const std::string& name, PartitionerType partitioner, std::unique_ptr<ICamera> camera);
 
     void destroyScene(const std::string& name);
 
     Scene* getScene(const std::string& name);
 
+    // Applies to existing scenes and to scenes created afterwards
+    void setInterpolation(bool enabled);
+
 private:
     std::unordered_map<std::string, std::unique_ptr<Scene>> scenes;
     std::weak_ptr<IMeshSystem> meshSys;
     std::weak_ptr<IMaterialSystem> matSys;
     std::weak_ptr<RendererAPI> renderer;
     std::unique_ptr<PipelineCache> pipelineCache;
+    bool interpolation = false;
 };
 
 } // namespace jaeng
@@ -28,8 +28,9 @@ public:
     // Return file contents or error
     virtual result<std::vector<uint8_t>> load(const std::string& path) = 0;
 
-    // Return file contents asynchronously
-    virtual async::Future<jaeng::result<std::vector<uint8_t>>> loadAsync(const std::string& path) = 0;
+    // Return file contents asynchronously. A cancelled token drops the read if it hasn't started
+    // and completes the future with error_code::cancelled.
+    virtual async::Future<jaeng::result<std::vector<uint8_t>>> loadAsync(const std::string& path, async::CancellationToken token = {}) = 0;
 
     // Register in-memory file
     virtual void registerMemoryFile(const std::string& path, const void* data, uint64_t byteSize) = 0;
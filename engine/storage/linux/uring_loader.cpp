@@ -0,0 +1,488 @@
+#include "uring_loader.h"
+#include "common/logging.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace jaeng {
+
+namespace {
+
+int sys_io_uring_setup(uint32_t entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int sys_io_uring_register(int fd, uint32_t opcode, const void* arg, uint32_t count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+uint32_t load_acquire(uint32_t* p) {
+    return std::atomic_ref<uint32_t>(*p).load(std::memory_order_acquire);
+}
+
+void store_release(uint32_t* p, uint32_t v) {
+    std::atomic_ref<uint32_t>(*p).store(v, std::memory_order_release);
+}
+
+// A single read never asks for more than this, larger files are read in several passes
+constexpr uint32_t kMaxReadChunk = 1u << 30;
+
+// user_data of the NOP that wakes the reaper on shutdown
+constexpr uint64_t kWakeTag = 0;
+
+const char kEmptyPath[] = "";
+
+} // namespace
+
+struct UringFileLoader::Request {
+    std::vector<std::string> candidates;
+    size_t candidate = 0;
+    std::shared_ptr<async::Future<LoadResult>::SharedState> promise;
+    async::CancellationToken token;
+
+    Stage stage = Stage::Open;
+    int fd = -1;
+    struct statx stx {};
+    uint64_t size = 0;
+    uint64_t offset = 0;
+    int32_t fixedIndex = -1;
+    std::vector<uint8_t> data;
+    std::optional<Error> error;
+
+    const std::string& path() const { return candidates[std::min(candidate, candidates.size() - 1)]; }
+
+    // Record a failure; the file descriptor still has to be closed before completing
+    void fail(error_code code, const std::string& msg) {
+        error = Error::fromMessage(static_cast<int>(code), msg);
+        stage = Stage::Close;
+    }
+};
+
+UringFileLoader::~UringFileLoader() {
+    shutdown();
+}
+
+result<> UringFileLoader::initialize(const Config& config) {
+    io_uring_params params{};
+    int fd = sys_io_uring_setup(config.queueDepth, &params);
+    JAENG_ERROR_IF(fd < 0, error_code::platform_error, std::string("[Uring] io_uring_setup failed: ") + strerror(errno));
+    ringFd_ = fd;
+
+    // Map the rings; newer kernels expose SQ and CQ rings through a single mapping
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+    sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) sqRing_ = nullptr;
+    if (singleMmap) {
+        cqRing_ = sqRing_;
+    } else {
+        cqRing_ = mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) cqRing_ = nullptr;
+    }
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    sqes_ = sqes == MAP_FAILED ? nullptr : static_cast<io_uring_sqe*>(sqes);
+
+    if (!sqRing_ || !cqRing_ || !sqes_) {
+        release_ring();
+        JAENG_ERROR(error_code::platform_error, "[Uring] Failed to map the io_uring rings");
+    }
+
+    auto* sq = static_cast<uint8_t*>(sqRing_);
+    sqTail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    sqMask_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    sqEntries_ = params.sq_entries;
+
+    auto* cq = static_cast<uint8_t*>(cqRing_);
+    cqHead_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    cqMask_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Make sure the kernel knows every opcode the request state machine relies on (5.6+)
+    constexpr uint32_t kProbeOps = 256;
+    std::vector<uint8_t> probeMemory(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op), 0);
+    auto* probe = reinterpret_cast<io_uring_probe*>(probeMemory.data());
+    if (sys_io_uring_register(fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) {
+        release_ring();
+        JAENG_ERROR(error_code::platform_error, "[Uring] Kernel does not support opcode probing");
+    }
+    for (uint8_t op : {IORING_OP_NOP, IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            release_ring();
+            JAENG_ERROR(error_code::platform_error, std::format("[Uring] Opcode {} is not supported", op));
+        }
+    }
+    bool fixedSupported = IORING_OP_READ_FIXED <= probe->last_op &&
+                          (probe->ops[IORING_OP_READ_FIXED].flags & IO_URING_OP_SUPPORTED);
+
+    // Registered buffers are optional: RLIMIT_MEMLOCK is often tiny, fall back to plain reads
+    if (fixedSupported && config.fixedBufferCount > 0 && config.fixedBufferSize > 0) {
+        size_t total = static_cast<size_t>(config.fixedBufferCount) * config.fixedBufferSize;
+        fixedMemory_ = static_cast<uint8_t*>(std::aligned_alloc(4096, (total + 4095) & ~size_t(4095)));
+
+        std::vector<iovec> iovecs(config.fixedBufferCount);
+        for (uint32_t i = 0; i < config.fixedBufferCount; ++i) {
+            iovecs[i].iov_base = fixedMemory_ + static_cast<size_t>(i) * config.fixedBufferSize;
+            iovecs[i].iov_len = config.fixedBufferSize;
+        }
+
+        if (fixedMemory_ && sys_io_uring_register(fd, IORING_REGISTER_BUFFERS, iovecs.data(), config.fixedBufferCount) == 0) {
+            fixedBufferSize_ = config.fixedBufferSize;
+            for (uint32_t i = config.fixedBufferCount; i > 0; --i) freeFixed_.push_back(static_cast<uint16_t>(i - 1));
+        } else {
+            JAENG_LOG_WARN("[Uring] Could not register {} fixed buffers ({}), using plain reads",
+                           config.fixedBufferCount, strerror(errno));
+            std::free(fixedMemory_);
+            fixedMemory_ = nullptr;
+        }
+    }
+
+    stopping_ = false;
+    reaper_ = std::thread(&UringFileLoader::reaper_loop, this);
+
+    JAENG_LOG_INFO("[Uring] io_uring file loader ready ({} entries, {} fixed buffers of {} KiB)",
+                   sqEntries_, freeFixed_.size(), fixedBufferSize_ / 1024);
+    return result<>();
+}
+
+void UringFileLoader::shutdown() {
+    if (ringFd_ < 0) return;
+
+    std::deque<Request*> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+        abandoned.swap(backlog_);
+
+        // Wake the reaper; it leaves once everything already in the ring has completed
+        io_uring_sqe* sqe = next_sqe_locked();
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = kWakeTag;
+        commit_sqe_locked();
+        submit_locked();
+    }
+
+    for (Request* req : abandoned) {
+        req->error = Error::fromMessage(static_cast<int>(error_code::resource_not_ready),
+                                        "[Uring] Loader shut down before reading: " + req->path());
+        finish(req);
+    }
+
+    if (reaper_.joinable()) reaper_.join();
+    release_ring();
+}
+
+void UringFileLoader::release_ring() {
+    if (sqes_) munmap(sqes_, sqesSize_);
+    if (cqRing_ && cqRing_ != sqRing_) munmap(cqRing_, cqRingSize_);
+    if (sqRing_) munmap(sqRing_, sqRingSize_);
+    sqes_ = nullptr;
+    sqRing_ = cqRing_ = nullptr;
+
+    if (ringFd_ >= 0) close(ringFd_);
+    ringFd_ = -1;
+
+    std::free(fixedMemory_);
+    fixedMemory_ = nullptr;
+    fixedBufferSize_ = 0;
+    freeFixed_.clear();
+}
+
+async::Future<UringFileLoader::LoadResult> UringFileLoader::load(std::vector<std::string> candidates, async::CancellationToken token) {
+    auto promise = std::make_shared<async::Future<LoadResult>::SharedState>();
+    if (candidates.empty()) {
+        promise->set_value(Error::fromMessage(static_cast<int>(error_code::invalid_args), "[Uring] No path to load"));
+        return async::Future<LoadResult>(promise);
+    }
+
+    auto* req = new Request();
+    req->candidates = std::move(candidates);
+    req->promise = promise;
+    req->token = std::move(token);
+
+    bool rejected = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || ringFd_ < 0) {
+            rejected = true;
+        } else {
+            enqueue_locked(req);
+            submit_locked();
+        }
+    }
+
+    if (rejected) {
+        req->error = Error::fromMessage(static_cast<int>(error_code::resource_not_ready), "[Uring] Loader is not running");
+        finish(req);
+    }
+    return async::Future<LoadResult>(promise);
+}
+
+io_uring_sqe* UringFileLoader::next_sqe_locked() {
+    // Every enqueue is followed by a submit, so the SQ ring never holds more than a batch
+    return &sqes_[*sqTail_ & *sqMask_];
+}
+
+void UringFileLoader::commit_sqe_locked() {
+    uint32_t tail = *sqTail_;
+    uint32_t index = tail & *sqMask_;
+    sqArray_[index] = index;
+    store_release(sqTail_, tail + 1);
+    ++inflight_;
+    ++toSubmit_;
+}
+
+void UringFileLoader::enqueue_locked(Request* req) {
+    // Bounding the ops in flight to the SQ size also keeps the (2x larger) CQ from overflowing
+    if (inflight_ >= sqEntries_) {
+        backlog_.push_back(req);
+        return;
+    }
+
+    prepare_sqe(next_sqe_locked(), req);
+    commit_sqe_locked();
+}
+
+void UringFileLoader::drain_backlog_locked(std::vector<Request*>& dropped) {
+    while (inflight_ < sqEntries_ && !backlog_.empty()) {
+        Request* req = backlog_.front();
+        backlog_.pop_front();
+        if (req->token.is_cancelled()) {
+            // Never started, nothing to close
+            req->error = async::cancelled_error();
+            dropped.push_back(req);
+            continue;
+        }
+        enqueue_locked(req);
+    }
+}
+
+void UringFileLoader::submit_locked() {
+    while (toSubmit_ > 0) {
+        int ret = sys_io_uring_enter(ringFd_, toSubmit_, 0, 0);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            JAENG_LOG_ERROR("[Uring] io_uring_enter(submit) failed: {}", strerror(errno));
+            return;
+        }
+        toSubmit_ -= std::min<uint32_t>(toSubmit_, static_cast<uint32_t>(ret));
+    }
+}
+
+void UringFileLoader::prepare_sqe(io_uring_sqe* sqe, Request* req) {
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = reinterpret_cast<uint64_t>(req);
+
+    switch (req->stage) {
+        case Stage::Open:
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<uint64_t>(req->path().c_str());
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            break;
+        case Stage::Stat:
+            sqe->opcode = IORING_OP_STATX;
+            sqe->fd = req->fd;
+            sqe->addr = reinterpret_cast<uint64_t>(kEmptyPath);
+            sqe->len = STATX_TYPE | STATX_SIZE;
+            sqe->off = reinterpret_cast<uint64_t>(&req->stx);
+            sqe->statx_flags = AT_EMPTY_PATH;
+            break;
+        case Stage::Read: {
+            uint64_t remaining = req->size - req->offset;
+            sqe->fd = req->fd;
+            sqe->off = req->offset;
+            sqe->len = static_cast<uint32_t>(std::min<uint64_t>(remaining, kMaxReadChunk));
+            if (req->fixedIndex >= 0) {
+                sqe->opcode = IORING_OP_READ_FIXED;
+                sqe->buf_index = static_cast<uint16_t>(req->fixedIndex);
+                sqe->addr = reinterpret_cast<uint64_t>(fixedMemory_ + static_cast<size_t>(req->fixedIndex) * fixedBufferSize_ + req->offset);
+            } else {
+                sqe->opcode = IORING_OP_READ;
+                sqe->addr = reinterpret_cast<uint64_t>(req->data.data() + req->offset);
+            }
+            break;
+        }
+        case Stage::Close:
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = req->fd;
+            break;
+    }
+}
+
+bool UringFileLoader::on_completion(Request* req, int32_t res) {
+    bool done = false;
+
+    if (req->stage != Stage::Close && req->token.is_cancelled()) {
+        // Drop the rest of the pipeline; an open descriptor still has to be closed
+        if (req->stage == Stage::Open && res >= 0) req->fd = res;
+        if (req->fd >= 0) {
+            req->error = async::cancelled_error();
+            req->stage = Stage::Close;
+        } else {
+            req->error = async::cancelled_error();
+            done = true;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --inflight_;
+        if (!done) enqueue_locked(req);
+        return done;
+    }
+
+    switch (req->stage) {
+        case Stage::Open:
+            if (res >= 0) {
+                req->fd = res;
+                req->stage = Stage::Stat;
+            } else if (req->candidate + 1 < req->candidates.size()) {
+                ++req->candidate; // Try the next location
+            } else {
+                req->error = Error::fromMessage(static_cast<int>(error_code::no_resource),
+                                                "[FileManager] File not found in any location: " + req->candidates.front());
+                done = true;
+            }
+            break;
+
+        case Stage::Stat:
+            if (res < 0) {
+                req->fail(error_code::platform_error, std::format("[FileManager] statx failed on {}: {}", req->path(), strerror(-res)));
+            } else if (!S_ISREG(req->stx.stx_mode)) {
+                req->fail(error_code::no_resource, "[FileManager] Not a regular file: " + req->path());
+            } else if (req->stx.stx_size == 0) {
+                req->fail(error_code::no_resource, "[FileManager] File is empty: " + req->path());
+            } else {
+                req->size = req->stx.stx_size;
+                if (req->size <= fixedBufferSize_ && !freeFixed_.empty()) {
+                    req->fixedIndex = freeFixed_.back();
+                    freeFixed_.pop_back();
+                } else {
+                    req->data.resize(req->size);
+                }
+                req->stage = Stage::Read;
+            }
+            break;
+
+        case Stage::Read:
+            if (res == -EAGAIN || res == -EINTR) {
+                break; // Resubmit the same read
+            }
+            if (res < 0) {
+                req->fail(error_code::platform_error, std::format("[FileManager] Read error on {}: {}", req->path(), strerror(-res)));
+            } else if (res == 0) {
+                // The file shrank underneath us, keep what was read
+                req->size = req->offset;
+                if (req->size == 0) req->fail(error_code::no_resource, "[FileManager] File is empty: " + req->path());
+                else req->stage = Stage::Close;
+            } else {
+                // Short reads simply resubmit from the new offset
+                req->offset += static_cast<uint64_t>(res);
+                if (req->offset >= req->size) req->stage = Stage::Close;
+            }
+            break;
+
+        case Stage::Close:
+            req->fd = -1;
+            done = true;
+            break;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    --inflight_;
+    if (!done) enqueue_locked(req);
+    return done;
+}
+
+void UringFileLoader::finish(Request* req) {
+    if (req->fixedIndex >= 0) {
+        if (!req->error) {
+            const uint8_t* src = fixedMemory_ + static_cast<size_t>(req->fixedIndex) * fixedBufferSize_;
+            req->data.assign(src, src + req->size);
+        }
+        freeFixed_.push_back(static_cast<uint16_t>(req->fixedIndex));
+        req->fixedIndex = -1;
+    } else if (!req->error) {
+        req->data.resize(req->size);
+    }
+
+    auto promise = std::move(req->promise);
+    if (req->error) {
+        if (req->error->code != static_cast<int>(error_code::cancelled)) JAENG_LOG_ERROR("{}", req->error->message);
+        LoadResult out(std::move(*req->error));
+        delete req;
+        promise->set_value(std::move(out));
+    } else {
+        JAENG_LOG_DEBUG("[FileManager] Successfully loaded {} bytes from {}", req->data.size(), req->path());
+        LoadResult out(std::move(req->data));
+        delete req;
+        promise->set_value(std::move(out));
+    }
+}
+
+void UringFileLoader::reaper_loop() {
+    std::vector<Request*> finished;
+
+    while (true) {
+        int ret = sys_io_uring_enter(ringFd_, 0, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0 && errno != EINTR) {
+            JAENG_LOG_ERROR("[Uring] io_uring_enter(wait) failed: {}", strerror(errno));
+            break;
+        }
+
+        uint32_t head = *cqHead_;
+        uint32_t tail = load_acquire(cqTail_);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & *cqMask_];
+            uint64_t tag = cqe.user_data;
+            int32_t res = cqe.res;
+            store_release(cqHead_, head + 1);
+
+            if (tag == kWakeTag) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --inflight_;
+                continue;
+            }
+
+            auto* req = reinterpret_cast<Request*>(tag);
+            if (on_completion(req, res)) finished.push_back(req);
+        }
+
+        bool exit = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            drain_backlog_locked(finished);
+            submit_locked();
+            exit = stopping_ && inflight_ == 0;
+        }
+
+        // Complete outside the lock, continuations may queue more loads
+        for (Request* req : finished) finish(req);
+        finished.clear();
+
+        if (exit) break;
+    }
+}
+
+} // namespace jaeng
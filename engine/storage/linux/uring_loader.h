@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/result.h"
+#include "common/async/task_scheduler.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace jaeng {
+
+// Asynchronous file reader on top of Linux io_uring (raw syscalls, no liburing).
+// Every request is driven through openat -> statx -> read(s) -> close by a single reaper
+// thread, so thousands of loads can be in flight without a thread per request.
+// Small files are read into registered (fixed) buffers to skip per-IO page pinning.
+class UringFileLoader {
+public:
+    using LoadResult = result<std::vector<uint8_t>>;
+
+    struct Config {
+        uint32_t queueDepth = 256;              // Operations in flight (SQ entries)
+        uint32_t fixedBufferCount = 32;         // Registered buffers, 0 disables READ_FIXED
+        uint32_t fixedBufferSize = 256 * 1024;  // Files up to this size use a registered buffer
+    };
+
+    UringFileLoader() = default;
+    ~UringFileLoader();
+
+    UringFileLoader(const UringFileLoader&) = delete;
+    UringFileLoader& operator=(const UringFileLoader&) = delete;
+
+    result<> initialize(const Config& config);
+    void shutdown();
+    bool is_available() const { return ringFd_ >= 0; }
+
+    // Loads the first candidate that opens as a regular file.
+    // The future is completed from the reaper thread. Cancellation is checked between ring
+    // operations, so a cancelled load stops after (at most) the operation in flight.
+    async::Future<LoadResult> load(std::vector<std::string> candidates, async::CancellationToken token = {});
+
+private:
+    enum class Stage : uint8_t { Open, Stat, Read, Close };
+    struct Request;
+
+    void reaper_loop();
+    bool on_completion(Request* req, int32_t res); // Returns true once the request is complete
+    void finish(Request* req);
+
+    // All of the below require mutex_ to be held
+    void enqueue_locked(Request* req);
+    void prepare_sqe(io_uring_sqe* sqe, Request* req);
+    io_uring_sqe* next_sqe_locked();
+    void commit_sqe_locked();
+    void submit_locked();
+    void drain_backlog_locked(std::vector<Request*>& dropped);
+
+    void release_ring();
+
+    int ringFd_ = -1;
+
+    // Submission ring
+    void* sqRing_ = nullptr;
+    size_t sqRingSize_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqesSize_ = 0;
+    uint32_t* sqTail_ = nullptr;
+    uint32_t* sqMask_ = nullptr;
+    uint32_t* sqArray_ = nullptr;
+    uint32_t sqEntries_ = 0;
+
+    // Completion ring (may share the submission mapping)
+    void* cqRing_ = nullptr;
+    size_t cqRingSize_ = 0;
+    uint32_t* cqHead_ = nullptr;
+    uint32_t* cqTail_ = nullptr;
+    uint32_t* cqMask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    // Registered buffers
+    uint8_t* fixedMemory_ = nullptr;
+    uint32_t fixedBufferSize_ = 0;
+    std::vector<uint16_t> freeFixed_;
+
+    std::mutex mutex_;
+    std::deque<Request*> backlog_; // Requests waiting for a free ring slot
+    uint32_t inflight_ = 0;
+    uint32_t toSubmit_ = 0;
+    bool stopping_ = false;
+    std::thread reaper_;
+};
+
+} // namespace jaeng
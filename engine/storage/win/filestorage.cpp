@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <cstring>
@@ -20,6 +21,9 @@ FileManager::FileManager() : eventBus(std::make_shared<EventBus>()) {
 }
 
 FileManager::~FileManager() {
+#ifdef JAENG_LINUX
+    uring_.shutdown();
+#endif
     stopWatcher_ = true;
 #ifdef JAENG_LINUX
     if (inotifyFd_ != -1) {
@@ -40,6 +44,12 @@ result<> FileManager::initialize() {
         return Error::fromMessage(errno, "Failed to initialize inotify");
     }
     watcherThread_ = std::thread(&FileManager::watcherLoop, this);
+
+    if (!uring_.is_available()) {
+        uring_.initialize({}).orElse([](auto) {
+            JAENG_LOG_WARN("[FileManager] io_uring unavailable, async loads go through the IO worker");
+        });
+    }
 #endif
     return result<>();
 }
@@ -58,7 +68,13 @@ result<std::vector<uint8_t>> FileManager::load(const std::string& path) {
     return data;
 }
 
-async::Future<result<std::vector<uint8_t>>> FileManager::loadAsync(const std::string& path) {
+async::Future<result<std::vector<uint8_t>>> FileManager::loadAsync(const std::string& path, async::CancellationToken token) {
+    if (token.is_cancelled()) {
+        async::Future<result<std::vector<uint8_t>>> f;
+        f.get_shared_state()->set_value(async::cancelled_error());
+        return f;
+    }
+
     {
         std::lock_guard<std::mutex> lock(storageMutex_);
         if (auto it = memoryFiles.find(path); it != memoryFiles.end()) {
@@ -68,6 +84,14 @@ async::Future<result<std::vector<uint8_t>>> FileManager::loadAsync(const std::st
         }
     }
     
+#ifdef JAENG_LINUX
+    // Custom load or exists hooks (e.g. packed assets) must see every read and pick the same candidate
+    // as loadFromDisk, so only plain files take the ring
+    if (uring_.is_available() && !load_func_ && !exists_func_) {
+        return uring_.load(candidatePaths(path), std::move(token));
+    }
+#endif
+
     auto* scheduler = async::get_current_scheduler();
     if (!scheduler) {
         async::Future<result<std::vector<uint8_t>>> f;
@@ -75,7 +99,7 @@ async::Future<result<std::vector<uint8_t>>> FileManager::loadAsync(const std::st
         return f;
     }
 
-    return scheduler->enqueue_io([this, path]() -> result<std::vector<uint8_t>> {
+    return scheduler->enqueue_io(std::move(token), [this, path]() -> result<std::vector<uint8_t>> {
         auto data = loadFromDisk(path);
         if (data.empty()) {
             return Error::fromMessage((int)error_code::no_resource, "[FileManager] Failed to load: " + path);
@@ -152,6 +176,24 @@ std::unique_ptr<FileManager::SubscriptionT> FileManager::track(const std::string
     return eventBus->subscribe(callback);
 }
 
+std::vector<std::string> FileManager::candidatePaths(const std::string& path) const {
+    std::vector<std::string> candidates;
+    auto add = [&](std::string p) {
+        if (!p.empty() && std::find(candidates.begin(), candidates.end(), p) == candidates.end()) {
+            candidates.push_back(std::move(p));
+        }
+    };
+
+    if (resolver_) add(resolver_(path));
+    add(path);
+    if (!basePath_.empty()) {
+        std::string p = basePath_;
+        if (p.back() != '/') p += "/";
+        add(p + path);
+    }
+    return candidates;
+}
+
 std::vector<uint8_t> FileManager::loadFromDisk(const std::string& path) {
     std::string finalPath = path;
     bool found = false;
@@ -161,25 +203,11 @@ std::vector<uint8_t> FileManager::loadFromDisk(const std::string& path) {
         return file_exists_primitive(p);
     };
 
-    if (resolver_) {
-        std::string resolved = resolver_(path);
-        if (!resolved.empty() && check_exists(resolved)) {
-            finalPath = resolved;
-            found = true;
-        }
-    }
-
-    if (!found && check_exists(path)) {
-        found = true;
-    }
-
-    if (!found && !basePath_.empty()) {
-        std::string p = basePath_;
-        if (!p.empty() && p.back() != '/') p += "/";
-        p += path;
-        if (check_exists(p)) {
-            finalPath = p;
+    for (const auto& candidate : candidatePaths(path)) {
+        if (check_exists(candidate)) {
+            finalPath = candidate;
             found = true;
+            break;
         }
     }
     
@@ -7,6 +7,10 @@
 
 #include "storage/ifstorage.h"
 
+#ifdef JAENG_LINUX
+#include "storage/linux/uring_loader.h"
+#endif
+
 namespace jaeng {
 
 class FileManager : public IFileManager {
@@ -28,7 +32,7 @@ public:
     void set_load_func(std::function<std::vector<uint8_t>(const std::string&)> load_func) { load_func_ = load_func; }
 
     result<std::vector<uint8_t>> load(const std::string& path) override;
-    async::Future<result<std::vector<uint8_t>>> loadAsync(const std::string& path) override;
+    async::Future<result<std::vector<uint8_t>>> loadAsync(const std::string& path, async::CancellationToken token = {}) override;
 
     void registerMemoryFile(const std::string& path, const void* data, uint64_t byteSize) override;
 
@@ -46,6 +50,8 @@ private:
     std::shared_ptr<EventBus> eventBus;
 
     std::vector<uint8_t> loadFromDisk(const std::string& path);
+    // Locations to try for a path, in lookup order (resolver, as-is, base path)
+    std::vector<std::string> candidatePaths(const std::string& path) const;
 
     // File Watcher
     void watcherLoop();
@@ -57,6 +63,9 @@ private:
     int inotifyFd_ = -1;
     std::unordered_map<int, std::string> watchDescriptors_;
     std::unordered_map<std::string, int> pathToWatch_;
+
+    // Keeps many reads in flight from a single thread; loadAsync falls back to the IO worker without it
+    UringFileLoader uring_;
 #endif
 };
 
@@ -1,6 +1,6 @@
 #include "ui.h"
 #include "fontsys.h"
-#include "scene/ipartition.h"
+#include "scene/render_commands.h"
 #include <vector>
 #include <algorithm>
 
@@ -307,7 +307,7 @@ void UITweenSystem::update(EntityManager& ecs, float dt) {
     }
 }
 
-void UIRenderSystem::extract(EntityManager& ecs, IFontSystem& fontSys, std::vector<RenderCommand>& outCommands) {
+void UIRenderSystem::extract(EntityManager& ecs, IFontSystem& fontSys, RenderCommandStream& outCommands) {
     const auto& entities = ecs.getAllEntities<RectTransform>();
     
     for (auto e : entities) {
@@ -324,9 +324,7 @@ void UIRenderSystem::extract(EntityManager& ecs, IFontSystem& fontSys, std::vect
 
         // Render Background (UIRenderable)
         if (auto* ur = ecs.getComponent<UIRenderable>(e)) {
-            RenderCommand cmd;
-            cmd.type = RenderCommandType::UpdateUI;
-            cmd.uiProxy = UIRenderProxy{
+            UIRenderProxy& proxy = outCommands.pushUpdateUI(UIRenderProxy{
                 static_cast<uint32_t>(e),
                 rt->worldRect.x, rt->worldRect.y, rt->worldRect.w, rt->worldRect.h,
                 rt->zIndex,
@@ -336,9 +334,8 @@ void UIRenderSystem::extract(EntityManager& ecs, IFontSystem& fontSys, std::vect
                 cb,
                 ur->uvRect,
                 ur->textureHandle
-            };
-            cmd.uiProxy.clipRect = rt->clipRect;
-            outCommands.push_back(cmd);
+            });
+            proxy.clipRect = rt->clipRect;
         }
 
         // Render Text (UIText)
@@ -399,9 +396,7 @@ void UIRenderSystem::extract(EntityManager& ecs, IFontSystem& fontSys, std::vect
                         float u1 = (float)glyph.x1 / fontData->atlasSize;
                         float v1 = (float)glyph.y1 / fontData->atlasSize;
 
-                        RenderCommand cmd;
-                        cmd.type = RenderCommandType::UpdateUI;
-                        cmd.uiProxy = UIRenderProxy{
+                        UIRenderProxy& proxy = outCommands.pushUpdateUI(UIRenderProxy{
                             (static_cast<uint32_t>(e) << 16) | (static_cast<uint32_t>(i) & 0xFFFF),
                             gx, gy, gw, gh,
                             rt->zIndex + 1,
@@ -411,10 +406,8 @@ void UIRenderSystem::extract(EntityManager& ecs, IFontSystem& fontSys, std::vect
                             cb,
                             {u0, v0, u1 - u0, v1 - v0},
                             fontData->texture
-                        };
-                        cmd.uiProxy.clipRect = rt->clipRect;
-
-                        outCommands.push_back(cmd);
+                        });
+                        proxy.clipRect = rt->clipRect;
 
                         x += glyph.xadvance * fontScale;
                     }
@@ -13,7 +13,7 @@
 namespace jaeng {
 
 struct UIRenderProxy;
-struct RenderCommand;
+class RenderCommandStream;
 class IFontSystem;
 
 // 2D Rect matching Unity's RectTransform concept.
@@ -106,7 +106,7 @@ public:
  */
 class UIRenderSystem {
 public:
-    static void extract(EntityManager& ecs, IFontSystem& fontSys, std::vector<RenderCommand>& outCommands);
+    static void extract(EntityManager& ecs, IFontSystem& fontSys, RenderCommandStream& outCommands);
 };
 
 class UITweenSystem {
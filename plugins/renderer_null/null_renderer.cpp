@@ -0,0 +1,493 @@
+#include "render/public/renderer_api.h"
+#include "common/logging.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Renderer backend that draws nothing. Resources get real handles (unique, tracked until destroyed,
+// misuse is counted) and every call is tallied per frame, so Scene, RenderGraph and extraction costs
+// can be measured without a GPU. Stats are read through RendererAPI::get_stats.
+
+using namespace jaeng::renderer;
+
+namespace {
+
+struct NullBuffer {
+    uint64_t size;
+    uint32_t usage;
+};
+
+struct NullTexture {
+    TextureDesc desc;
+    uint32_t index; // Bindless slot
+};
+
+struct NullSwapchain {
+    SwapchainDesc desc;
+    TextureHandle backbuffer;
+    TextureHandle depth;
+};
+
+// Counters for the frame being recorded. Atomics, since uploads may come from loader threads.
+struct FrameCounters {
+    std::atomic<uint32_t> drawCalls{0};
+    std::atomic<uint32_t> instances{0};
+    std::atomic<uint64_t> vertices{0};
+    std::atomic<uint32_t> passes{0};
+    std::atomic<uint32_t> pipelineBinds{0};
+    std::atomic<uint32_t> uniformBinds{0};
+    std::atomic<uint32_t> vertexBufferBinds{0};
+    std::atomic<uint32_t> indexBufferBinds{0};
+    std::atomic<uint32_t> pushConstantCalls{0};
+    std::atomic<uint32_t> barriers{0};
+    std::atomic<uint32_t> commandLists{0};
+    std::atomic<uint32_t> submits{0};
+    std::atomic<uint32_t> bufferUpdates{0};
+    std::atomic<uint64_t> bytesUploaded{0};
+    std::atomic<uint32_t> resourcesCreated{0};
+    std::atomic<uint32_t> resourcesDestroyed{0};
+    std::atomic<uint32_t> invalidCalls{0};
+
+    // Moves the counters into out and restarts them
+    void drain(RendererStats& out) {
+        out.draw_calls = drawCalls.exchange(0, std::memory_order_relaxed);
+        out.instances = instances.exchange(0, std::memory_order_relaxed);
+        out.vertices = vertices.exchange(0, std::memory_order_relaxed);
+        out.passes = passes.exchange(0, std::memory_order_relaxed);
+        out.pipeline_binds = pipelineBinds.exchange(0, std::memory_order_relaxed);
+        out.uniform_binds = uniformBinds.exchange(0, std::memory_order_relaxed);
+        out.vertex_buffer_binds = vertexBufferBinds.exchange(0, std::memory_order_relaxed);
+        out.index_buffer_binds = indexBufferBinds.exchange(0, std::memory_order_relaxed);
+        out.push_constant_calls = pushConstantCalls.exchange(0, std::memory_order_relaxed);
+        out.barriers = barriers.exchange(0, std::memory_order_relaxed);
+        out.command_lists = commandLists.exchange(0, std::memory_order_relaxed);
+        out.submits = submits.exchange(0, std::memory_order_relaxed);
+        out.buffer_updates = bufferUpdates.exchange(0, std::memory_order_relaxed);
+        out.bytes_uploaded = bytesUploaded.exchange(0, std::memory_order_relaxed);
+        out.resources_created = resourcesCreated.exchange(0, std::memory_order_relaxed);
+        out.resources_destroyed = resourcesDestroyed.exchange(0, std::memory_order_relaxed);
+        out.invalid_calls = invalidCalls.exchange(0, std::memory_order_relaxed);
+    }
+};
+
+struct NullContext {
+    std::mutex resourceMutex;
+
+    std::unordered_map<BufferHandle, NullBuffer> buffers;
+    std::unordered_map<TextureHandle, NullTexture> textures;
+    std::unordered_map<SamplerHandle, uint32_t> samplers;
+    std::unordered_map<ShaderModuleHandle, ShaderStage> shaders;
+    std::unordered_map<VertexLayoutHandle, uint32_t> vertexLayouts;
+    std::unordered_map<PipelineHandle, GraphicsPipelineDesc> pipelines;
+    std::unordered_map<SwapchainHandle, NullSwapchain> swapchains;
+    std::vector<uint32_t> freeTextureIndices;
+
+    BufferHandle nextBufferHandle = 1;
+    TextureHandle nextTextureHandle = 1;
+    SamplerHandle nextSamplerHandle = 1;
+    ShaderModuleHandle nextShaderHandle = 1;
+    VertexLayoutHandle nextVertexLayoutHandle = 1;
+    PipelineHandle nextPipelineHandle = 1;
+    SwapchainHandle nextSwapchainHandle = 1;
+    uint32_t nextTextureIndex = 0;
+    uint32_t nextSamplerIndex = 0;
+
+    std::atomic<CommandListHandle> nextCommandList{1};
+    bool inPass = false;
+
+    FrameCounters current;
+    RendererStats lastFrame{};
+};
+
+NullContext* g_ctx = nullptr;
+
+void count_invalid(const char* call, uint32_t handle) {
+    g_ctx->current.invalidCalls.fetch_add(1, std::memory_order_relaxed);
+    JAENG_LOG_DEBUG("[NullRenderer] {} with invalid handle {}", call, handle);
+}
+
+template<typename Map>
+bool is_live(const Map& map, uint32_t handle) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    return map.count(handle) != 0;
+}
+
+// Creation helpers, resourceMutex held by the caller
+TextureHandle add_texture(const TextureDesc& desc) {
+    uint32_t index;
+    if (!g_ctx->freeTextureIndices.empty()) {
+        index = g_ctx->freeTextureIndices.back();
+        g_ctx->freeTextureIndices.pop_back();
+    } else {
+        index = g_ctx->nextTextureIndex++;
+    }
+    TextureHandle h = g_ctx->nextTextureHandle++;
+    g_ctx->textures[h] = NullTexture{ desc, index };
+    g_ctx->current.resourcesCreated.fetch_add(1, std::memory_order_relaxed);
+    return h;
+}
+
+void remove_texture(TextureHandle h) {
+    auto it = g_ctx->textures.find(h);
+    if (it == g_ctx->textures.end()) {
+        count_invalid("destroy_texture", h);
+        return;
+    }
+    g_ctx->freeTextureIndices.push_back(it->second.index);
+    g_ctx->textures.erase(it);
+    g_ctx->current.resourcesDestroyed.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+extern "C" {
+
+// --- Lifecycle ---
+static bool null_init(const RendererDesc*) {
+    g_ctx = new NullContext();
+    JAENG_LOG_INFO("[NullRenderer] Initialized");
+    return true;
+}
+
+static void null_shutdown() {
+    if (!g_ctx) return;
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    size_t leaked = g_ctx->buffers.size() + g_ctx->textures.size() + g_ctx->samplers.size() +
+                    g_ctx->shaders.size() + g_ctx->vertexLayouts.size() + g_ctx->pipelines.size();
+    if (leaked > 0) {
+        JAENG_LOG_DEBUG("[NullRenderer] Shutdown with {} live resources", leaked);
+    }
+    delete g_ctx;
+    g_ctx = nullptr;
+}
+
+static bool null_begin_frame() { return g_ctx != nullptr; }
+
+static void null_end_frame() {
+    RendererStats stats{};
+    g_ctx->current.drain(stats);
+
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    stats.frame = g_ctx->lastFrame.frame + 1;
+    stats.live_buffers = static_cast<uint32_t>(g_ctx->buffers.size());
+    stats.live_textures = static_cast<uint32_t>(g_ctx->textures.size());
+    stats.live_pipelines = static_cast<uint32_t>(g_ctx->pipelines.size());
+    g_ctx->lastFrame = stats;
+}
+
+static bool null_get_stats(RendererStats* out) {
+    if (!g_ctx || !out) return false;
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    *out = g_ctx->lastFrame;
+    return true;
+}
+
+static void null_wait_idle() {}
+
+// --- Swapchain ---
+static SwapchainHandle null_create_swapchain(const SwapchainDesc* desc) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    NullSwapchain s{ *desc, 0, 0 };
+    s.backbuffer = add_texture({ desc->format, desc->size.width, desc->size.height, 1, 1, Access_ColorWrite });
+    s.depth = add_texture({ desc->depth_stencil.depth_format, desc->size.width, desc->size.height, 1, 1, Access_DepthWrite });
+    SwapchainHandle h = g_ctx->nextSwapchainHandle++;
+    g_ctx->swapchains[h] = s;
+    return h;
+}
+
+static void null_resize_swapchain(SwapchainHandle h, Extent2D size) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    auto it = g_ctx->swapchains.find(h);
+    if (it == g_ctx->swapchains.end()) return count_invalid("resize_swapchain", h);
+    it->second.desc.size = size;
+    for (TextureHandle t : { it->second.backbuffer, it->second.depth }) {
+        auto tex = g_ctx->textures.find(t);
+        if (tex != g_ctx->textures.end()) {
+            tex->second.desc.width = size.width;
+            tex->second.desc.height = size.height;
+        }
+    }
+}
+
+static void null_set_present_mode(SwapchainHandle h, PresentMode mode) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    auto it = g_ctx->swapchains.find(h);
+    if (it == g_ctx->swapchains.end()) return count_invalid("set_present_mode", h);
+    it->second.desc.present_mode = mode;
+}
+
+static void null_destroy_swapchain(SwapchainHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    auto it = g_ctx->swapchains.find(h);
+    if (it == g_ctx->swapchains.end()) return count_invalid("destroy_swapchain", h);
+    remove_texture(it->second.backbuffer);
+    remove_texture(it->second.depth);
+    g_ctx->swapchains.erase(it);
+}
+
+static TextureHandle null_get_current_backbuffer(SwapchainHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    auto it = g_ctx->swapchains.find(h);
+    return it != g_ctx->swapchains.end() ? it->second.backbuffer : 0;
+}
+
+static TextureHandle null_get_depth_buffer(SwapchainHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    auto it = g_ctx->swapchains.find(h);
+    return it != g_ctx->swapchains.end() ? it->second.depth : 0;
+}
+
+static void null_set_platform_drawable(void*) {}
+
+static void null_present(SwapchainHandle h) {
+    if (!is_live(g_ctx->swapchains, h)) count_invalid("present", h);
+}
+
+// --- Buffers ---
+static BufferHandle null_create_buffer(const BufferDesc* desc, const void* initial_data) {
+    if (!desc || desc->size_bytes == 0) return 0;
+    if (initial_data) g_ctx->current.bytesUploaded.fetch_add(desc->size_bytes, std::memory_order_relaxed);
+    g_ctx->current.resourcesCreated.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    BufferHandle h = g_ctx->nextBufferHandle++;
+    g_ctx->buffers[h] = NullBuffer{ desc->size_bytes, desc->usage };
+    return h;
+}
+
+static void null_destroy_buffer(BufferHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    if (g_ctx->buffers.erase(h) == 0) return count_invalid("destroy_buffer", h);
+    g_ctx->current.resourcesDestroyed.fetch_add(1, std::memory_order_relaxed);
+}
+
+static bool null_update_buffer(BufferHandle h, uint64_t dst_offset, const void* data, uint64_t size) {
+    {
+        std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+        auto it = g_ctx->buffers.find(h);
+        if (it == g_ctx->buffers.end() || !data || dst_offset + size > it->second.size) {
+            count_invalid("update_buffer", h);
+            return false;
+        }
+    }
+    g_ctx->current.bufferUpdates.fetch_add(1, std::memory_order_relaxed);
+    g_ctx->current.bytesUploaded.fetch_add(size, std::memory_order_relaxed);
+    return true;
+}
+
+// --- Textures & samplers ---
+static TextureHandle null_create_texture(const TextureDesc* desc, const void* initial_data) {
+    if (!desc || desc->width == 0 || desc->height == 0) return 0;
+    if (initial_data) {
+        // Every supported format is 4 bytes per texel
+        uint64_t bytes = uint64_t(desc->width) * desc->height * 4 * (desc->layers ? desc->layers : 1);
+        g_ctx->current.bytesUploaded.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    return add_texture(*desc);
+}
+
+static void null_destroy_texture(TextureHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    remove_texture(h);
+}
+
+static SamplerHandle null_create_sampler(const SamplerDesc*) {
+    g_ctx->current.resourcesCreated.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    SamplerHandle h = g_ctx->nextSamplerHandle++;
+    g_ctx->samplers[h] = g_ctx->nextSamplerIndex++;
+    return h;
+}
+
+static void null_destroy_sampler(SamplerHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    if (g_ctx->samplers.erase(h) == 0) return count_invalid("destroy_sampler", h);
+    g_ctx->current.resourcesDestroyed.fetch_add(1, std::memory_order_relaxed);
+}
+
+static uint32_t null_get_texture_index(TextureHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    auto it = g_ctx->textures.find(h);
+    return it != g_ctx->textures.end() ? it->second.index : 0;
+}
+
+static uint32_t null_get_sampler_index(SamplerHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    auto it = g_ctx->samplers.find(h);
+    return it != g_ctx->samplers.end() ? it->second : 0;
+}
+
+// --- Shaders & pipelines ---
+static ShaderModuleHandle null_create_shader_module(const ShaderModuleDesc* desc) {
+    if (!desc || !desc->data || desc->size == 0) return 0;
+    g_ctx->current.resourcesCreated.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    ShaderModuleHandle h = g_ctx->nextShaderHandle++;
+    g_ctx->shaders[h] = desc->stage;
+    return h;
+}
+
+static void null_destroy_shader_module(ShaderModuleHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    if (g_ctx->shaders.erase(h) == 0) return count_invalid("destroy_shader_module", h);
+    g_ctx->current.resourcesDestroyed.fetch_add(1, std::memory_order_relaxed);
+}
+
+static VertexLayoutHandle null_create_vertex_layout(const VertexLayoutDesc* desc) {
+    if (!desc) return 0;
+    g_ctx->current.resourcesCreated.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    VertexLayoutHandle h = g_ctx->nextVertexLayoutHandle++;
+    g_ctx->vertexLayouts[h] = desc->stride;
+    return h;
+}
+
+static void null_destroy_vertex_layout(VertexLayoutHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    if (g_ctx->vertexLayouts.erase(h) == 0) return count_invalid("destroy_vertex_layout", h);
+    g_ctx->current.resourcesDestroyed.fetch_add(1, std::memory_order_relaxed);
+}
+
+static PipelineHandle null_create_graphics_pipeline(const GraphicsPipelineDesc* desc) {
+    if (!desc) return 0;
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    // Same validation a real backend would fail on
+    if (!g_ctx->shaders.count(desc->vs) || !g_ctx->vertexLayouts.count(desc->vertex_layout) ||
+        (desc->fs != 0 && !g_ctx->shaders.count(desc->fs))) {
+        count_invalid("create_graphics_pipeline", desc->vs);
+        return 0;
+    }
+    PipelineHandle h = g_ctx->nextPipelineHandle++;
+    g_ctx->pipelines[h] = *desc;
+    g_ctx->current.resourcesCreated.fetch_add(1, std::memory_order_relaxed);
+    return h;
+}
+
+static void null_destroy_pipeline(PipelineHandle h) {
+    std::lock_guard<std::mutex> lock(g_ctx->resourceMutex);
+    if (g_ctx->pipelines.erase(h) == 0) return count_invalid("destroy_pipeline", h);
+    g_ctx->current.resourcesDestroyed.fetch_add(1, std::memory_order_relaxed);
+}
+
+// --- Command encoding (render thread) ---
+static CommandListHandle null_begin_commands() {
+    g_ctx->current.commandLists.fetch_add(1, std::memory_order_relaxed);
+    return g_ctx->nextCommandList.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void null_cmd_begin_pass(CommandListHandle, LoadOp, const ColorAttachmentDesc* colors, uint32_t count, const DepthAttachmentDesc* depth) {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (colors[i].tex && !is_live(g_ctx->textures, colors[i].tex)) count_invalid("cmd_begin_pass", colors[i].tex);
+    }
+    if (depth && depth->tex && !is_live(g_ctx->textures, depth->tex)) count_invalid("cmd_begin_pass", depth->tex);
+    g_ctx->current.passes.fetch_add(1, std::memory_order_relaxed);
+    g_ctx->inPass = true;
+}
+
+static void null_cmd_end_pass(CommandListHandle) {
+    g_ctx->inPass = false;
+}
+
+static void null_cmd_bind_uniform(CommandListHandle, uint32_t, BufferHandle h, uint64_t) {
+    if (!is_live(g_ctx->buffers, h)) count_invalid("cmd_bind_uniform", h);
+    g_ctx->current.uniformBinds.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void null_cmd_push_constants(CommandListHandle, uint32_t, uint32_t, const void*) {
+    g_ctx->current.pushConstantCalls.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void null_cmd_barrier(CommandListHandle, BufferHandle, uint32_t, uint32_t) {
+    g_ctx->current.barriers.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void null_cmd_set_pipeline(CommandListHandle, PipelineHandle h) {
+    if (!is_live(g_ctx->pipelines, h)) count_invalid("cmd_set_pipeline", h);
+    g_ctx->current.pipelineBinds.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void null_cmd_set_vertex_buffer(CommandListHandle, uint32_t, BufferHandle h, uint64_t) {
+    if (!is_live(g_ctx->buffers, h)) count_invalid("cmd_set_vertex_buffer", h);
+    g_ctx->current.vertexBufferBinds.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void null_cmd_set_index_buffer(CommandListHandle, BufferHandle h, bool, uint64_t) {
+    if (!is_live(g_ctx->buffers, h)) count_invalid("cmd_set_index_buffer", h);
+    g_ctx->current.indexBufferBinds.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void null_cmd_set_scissor(CommandListHandle, uint32_t, uint32_t, uint32_t, uint32_t) {}
+
+static void count_draw(uint32_t count, uint32_t instances) {
+    if (!g_ctx->inPass) count_invalid("cmd_draw outside a pass", 0);
+    g_ctx->current.drawCalls.fetch_add(1, std::memory_order_relaxed);
+    g_ctx->current.instances.fetch_add(instances, std::memory_order_relaxed);
+    g_ctx->current.vertices.fetch_add(uint64_t(count) * instances, std::memory_order_relaxed);
+}
+
+static void null_cmd_draw(CommandListHandle, uint32_t vtx_count, uint32_t instance_count, uint32_t, uint32_t) {
+    count_draw(vtx_count, instance_count);
+}
+
+static void null_cmd_draw_indexed(CommandListHandle, uint32_t idx_count, uint32_t inst_count, uint32_t, int32_t, uint32_t) {
+    count_draw(idx_count, inst_count);
+}
+
+static void null_end_commands(CommandListHandle) {}
+
+static void null_submit(CommandListHandle*, uint32_t) {
+    g_ctx->current.submits.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // extern "C"
+
+extern "C" RENDERER_API bool LoadRenderer(jaeng::renderer::RendererAPI* out_api) {
+    *out_api = {};
+    out_api->init = null_init;
+    out_api->shutdown = null_shutdown;
+    out_api->begin_frame = null_begin_frame;
+    out_api->end_frame = null_end_frame;
+    out_api->create_swapchain = null_create_swapchain;
+    out_api->resize_swapchain = null_resize_swapchain;
+    out_api->set_platform_drawable = null_set_platform_drawable;
+    out_api->set_present_mode = null_set_present_mode;
+    out_api->destroy_swapchain = null_destroy_swapchain;
+    out_api->get_current_backbuffer = null_get_current_backbuffer;
+    out_api->get_depth_buffer = null_get_depth_buffer;
+    out_api->present = null_present;
+    out_api->create_buffer = null_create_buffer;
+    out_api->update_buffer = null_update_buffer;
+    out_api->destroy_buffer = null_destroy_buffer;
+    out_api->create_texture = null_create_texture;
+    out_api->destroy_texture = null_destroy_texture;
+    out_api->get_texture_index = null_get_texture_index;
+    out_api->create_sampler = null_create_sampler;
+    out_api->destroy_sampler = null_destroy_sampler;
+    out_api->get_sampler_index = null_get_sampler_index;
+    out_api->create_shader_module = null_create_shader_module;
+    out_api->destroy_shader_module = null_destroy_shader_module;
+    out_api->create_vertex_layout = null_create_vertex_layout;
+    out_api->destroy_vertex_layout = null_destroy_vertex_layout;
+    out_api->create_graphics_pipeline = null_create_graphics_pipeline;
+    out_api->destroy_pipeline = null_destroy_pipeline;
+    out_api->begin_commands = null_begin_commands;
+    out_api->cmd_begin_pass = null_cmd_begin_pass;
+    out_api->cmd_end_pass = null_cmd_end_pass;
+    out_api->cmd_draw = null_cmd_draw;
+    out_api->cmd_draw_indexed = null_cmd_draw_indexed;
+    out_api->cmd_set_pipeline = null_cmd_set_pipeline;
+    out_api->cmd_set_vertex_buffer = null_cmd_set_vertex_buffer;
+    out_api->cmd_set_index_buffer = null_cmd_set_index_buffer;
+    out_api->cmd_set_scissor = null_cmd_set_scissor;
+    out_api->cmd_bind_uniform = null_cmd_bind_uniform;
+    out_api->cmd_push_constants = null_cmd_push_constants;
+    out_api->cmd_barrier = null_cmd_barrier;
+    out_api->end_commands = null_end_commands;
+    out_api->submit = null_submit;
+    out_api->wait_idle = null_wait_idle;
+    out_api->get_stats = null_get_stats;
+    return true;
+}
@@ -15,24 +15,31 @@ cbuffer CBFrame : register(b5, space0)
     float4x4 ViewProj;
 #endif
 };
-[[vk::binding(6, 0)]]
-cbuffer CBObject : register(b6, space0)
-{
+// Per-instance data, indexed by SV_InstanceID. Materials setting "maxInstances" (at most this many)
+// let the scene pack runs of draws sharing a mesh and material into one instanced draw.
+#define JAENG_MAX_INSTANCES 32
+
+struct InstanceData {
 #if defined(JAENG_VULKAN)
     row_major float4x4 World;
-    float4 MaterialColor;
-    float4 MaterialUVRect;
 #else
     float4x4 World;
+#endif
     float4 MaterialColor;
     float4 MaterialUVRect;
-#endif
+};
+
+[[vk::binding(6, 0)]]
+cbuffer CBObject : register(b6, space0)
+{
+    InstanceData Instances[JAENG_MAX_INSTANCES];
 };
 
 struct VSIn {
     float3 pos: POSITION;
     float3 col: COLOR;
     float2 uv: TEXCOORD;
+    uint instance: SV_InstanceID;
 };
 
 struct VSOut {
@@ -42,14 +49,15 @@ struct VSOut {
 };
 
 VSOut main(VSIn v) {
+    InstanceData inst = Instances[v.instance];
     VSOut o;
 #if defined(JAENG_VULKAN)
-    o.pos = mul(mul(float4(v.pos, 1.0), World), ViewProj);
+    o.pos = mul(mul(float4(v.pos, 1.0), inst.World), ViewProj);
 #else
     // D3D12 and Metal/Apple use pre-multiplication for column-major matrices (glm default)
-    o.pos = mul(ViewProj, mul(World, float4(v.pos, 1.0)));
+    o.pos = mul(ViewProj, mul(inst.World, float4(v.pos, 1.0)));
 #endif
-    o.col = float4(v.col, 1.0) * MaterialColor;
-    o.uv = v.uv * MaterialUVRect.zw + MaterialUVRect.xy;
+    o.col = float4(v.col, 1.0) * inst.MaterialColor;
+    o.uv = v.uv * inst.MaterialUVRect.zw + inst.MaterialUVRect.xy;
     return o;
 }
@@ -234,6 +234,8 @@ ReflectData fromReflection(ID3D12ShaderReflection* vsr, ID3D12ShaderReflection*
     for (UINT i = 0; i < vsDesc.InputParameters; i++) {
         D3D12_SIGNATURE_PARAMETER_DESC p;
         vsr->GetInputParameterDesc(i, &p);
+        // System values (SV_InstanceID, SV_VertexID) are generated, not read from the vertex buffer
+        if (p.SystemValueType != D3D_NAME_UNDEFINED) continue;
         r.vsParams.push_back({ r.stride, p.SemanticName });
         if (p.Mask == 1) r.stride += 4;
         else if (p.Mask <= 3) r.stride += 8;
@@ -0,0 +1,541 @@
+// Replays a RendererAPI capture (AppConfig::renderCapturePath) against a backend plugin and reports
+// the CPU time each frame spends in the API, from begin_frame until end_frame returns.
+//
+// Usage: render_replay <capture.jrc> <plugin> [--headless] [--warmup N] [--loops N] [--csv out.csv]
+//
+// Setup records (everything before the first frame) run once. With --loops the frames are replayed
+// again: resources they created and did not destroy are destroyed between passes, so each pass
+// creates its own, and the teardown after the last frame only runs at the end. Bindless indices inside push constants and uniform data are replayed verbatim, so
+// they are only meaningful when the backend allocates them in the same order as the captured one.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "platform/public/platform_api.h"
+#include "render/capture/capture_format.h"
+#include "render/public/renderer_plugin.h"
+
+using namespace jaeng;
+using namespace jaeng::renderer;
+using namespace jaeng::renderer::capture;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    std::string capturePath;
+    std::string pluginPath;
+    std::string csvPath;
+    bool headless = false;
+    uint32_t warmup = 0;
+    uint32_t loops = 1;
+};
+
+struct Record {
+    Op op;
+    const uint8_t* data;
+    uint32_t size;
+};
+
+// Captured handle -> handle returned by the replay backend; unknown handles map to 0
+class HandleMap {
+public:
+    void set(RendererHandle captured, RendererHandle live) { if (captured) map_[captured] = live; }
+    // For handles a Create* record returned; while tracking they are remembered until destroyed
+    void create(RendererHandle captured, RendererHandle live, bool track) {
+        set(captured, live);
+        if (track && captured) created_.push_back(captured);
+    }
+    RendererHandle operator[](RendererHandle captured) const {
+        auto it = map_.find(captured);
+        return it != map_.end() ? it->second : 0;
+    }
+    RendererHandle take(RendererHandle captured) {
+        auto it = map_.find(captured);
+        if (it == map_.end()) return 0;
+        RendererHandle live = it->second;
+        map_.erase(it);
+        std::erase(created_, captured);
+        return live;
+    }
+    // Forgets the tracked handles still alive, returning their live handles (newest first)
+    std::vector<RendererHandle> takeCreated() {
+        std::vector<RendererHandle> live;
+        while (!created_.empty()) {
+            RendererHandle captured = created_.back();
+            live.push_back(take(captured));
+        }
+        return live;
+    }
+
+private:
+    std::unordered_map<RendererHandle, RendererHandle> map_;
+    std::vector<RendererHandle> created_;
+};
+
+class Replayer {
+public:
+    explicit Replayer(RendererAPI& api) : api_(api) {}
+
+    // Issues one captured call. Returns false on a malformed record.
+    bool execute(const Record& rec);
+
+    uint64_t mismatches() const { return mismatches_; }
+
+    // While on, resources created by the replayed records are tracked until they are destroyed
+    void setTracking(bool enabled) { tracking_ = enabled; }
+    // Destroys the tracked resources that are still alive
+    void releaseTracked();
+
+private:
+    RendererAPI& api_;
+    bool tracking_ = false;
+    HandleMap swapchains_, buffers_, textures_, samplers_, shaders_, layouts_, pipelines_, commands_;
+    uint64_t mismatches_ = 0;  // Calls whose result differs from the capture (failed creates, skipped frames)
+    std::vector<ColorAttachmentDesc> colors_;
+    std::vector<CommandListHandle> lists_;
+    std::vector<uint8_t> scratch_;
+};
+
+template<typename Fn, typename... Args>
+void call(Fn* fn, Args&&... args) {
+    if (fn) fn(std::forward<Args>(args)...);
+}
+
+void Replayer::releaseTracked() {
+    // Dependents first: pipelines reference shaders and layouts
+    for (RendererHandle h : pipelines_.takeCreated()) call(api_.destroy_pipeline, h);
+    for (RendererHandle h : layouts_.takeCreated()) call(api_.destroy_vertex_layout, h);
+    for (RendererHandle h : shaders_.takeCreated()) call(api_.destroy_shader_module, h);
+    for (RendererHandle h : samplers_.takeCreated()) call(api_.destroy_sampler, h);
+    for (RendererHandle h : textures_.takeCreated()) call(api_.destroy_texture, h);
+    for (RendererHandle h : buffers_.takeCreated()) call(api_.destroy_buffer, h);
+    for (RendererHandle h : swapchains_.takeCreated()) call(api_.destroy_swapchain, h);
+}
+
+bool Replayer::execute(const Record& rec) {
+    PayloadReader r(rec.data, rec.size);
+    uint64_t size = 0;
+
+    switch (rec.op) {
+    case Op::BeginFrame: {
+        bool captured = r.get<bool>();
+        bool ok = api_.begin_frame ? api_.begin_frame() : true;
+        if (ok != captured) ++mismatches_;
+        break;
+    }
+    case Op::EndFrame:
+        call(api_.end_frame);
+        break;
+    case Op::CreateSwapchain: {
+        auto desc = r.get<SwapchainDesc>();
+        auto captured = r.get<SwapchainHandle>();
+        SwapchainHandle h = api_.create_swapchain ? api_.create_swapchain(&desc) : 0;
+        if (!h && captured) ++mismatches_;
+        swapchains_.create(captured, h, tracking_);
+        break;
+    }
+    case Op::ResizeSwapchain: {
+        auto h = r.get<SwapchainHandle>();
+        auto extent = r.get<Extent2D>();
+        call(api_.resize_swapchain, swapchains_[h], extent);
+        break;
+    }
+    case Op::SetPresentMode: {
+        auto h = r.get<SwapchainHandle>();
+        auto mode = r.get<PresentMode>();
+        call(api_.set_present_mode, swapchains_[h], mode);
+        break;
+    }
+    case Op::DestroySwapchain:
+        call(api_.destroy_swapchain, swapchains_.take(r.get<SwapchainHandle>()));
+        break;
+    case Op::GetBackbuffer:
+    case Op::GetDepthBuffer: {
+        // The backbuffer changes every frame, so the captured handle is remapped each time
+        auto h = r.get<SwapchainHandle>();
+        auto captured = r.get<TextureHandle>();
+        auto fn = rec.op == Op::GetBackbuffer ? api_.get_current_backbuffer : api_.get_depth_buffer;
+        textures_.set(captured, fn ? fn(swapchains_[h]) : 0);
+        break;
+    }
+    case Op::CreateBuffer: {
+        auto desc = r.get<BufferDesc>();
+        const uint8_t* data = r.blob(size);
+        auto captured = r.get<BufferHandle>();
+        BufferHandle h = api_.create_buffer ? api_.create_buffer(&desc, data) : 0;
+        if (!h && captured) ++mismatches_;
+        buffers_.create(captured, h, tracking_);
+        break;
+    }
+    case Op::DestroyBuffer:
+        call(api_.destroy_buffer, buffers_.take(r.get<BufferHandle>()));
+        break;
+    case Op::UpdateBuffer: {
+        auto h = r.get<BufferHandle>();
+        auto offset = r.get<uint64_t>();
+        const uint8_t* data = r.blob(size);
+        if (api_.update_buffer && !api_.update_buffer(buffers_[h], offset, data, size)) ++mismatches_;
+        break;
+    }
+    case Op::CreateTexture: {
+        auto desc = r.get<TextureDesc>();
+        const uint8_t* data = r.blob(size);
+        auto captured = r.get<TextureHandle>();
+        TextureHandle h = api_.create_texture ? api_.create_texture(&desc, data) : 0;
+        if (!h && captured) ++mismatches_;
+        textures_.create(captured, h, tracking_);
+        break;
+    }
+    case Op::DestroyTexture:
+        call(api_.destroy_texture, textures_.take(r.get<TextureHandle>()));
+        break;
+    case Op::CreateSampler: {
+        auto desc = r.get<SamplerDesc>();
+        auto captured = r.get<SamplerHandle>();
+        SamplerHandle h = api_.create_sampler ? api_.create_sampler(&desc) : 0;
+        if (!h && captured) ++mismatches_;
+        samplers_.create(captured, h, tracking_);
+        break;
+    }
+    case Op::DestroySampler:
+        call(api_.destroy_sampler, samplers_.take(r.get<SamplerHandle>()));
+        break;
+    case Op::GetTextureIndex: {
+        auto h = r.get<TextureHandle>();
+        auto captured = r.get<uint32_t>();
+        if (api_.get_texture_index && api_.get_texture_index(textures_[h]) != captured) ++mismatches_;
+        break;
+    }
+    case Op::GetSamplerIndex: {
+        auto h = r.get<SamplerHandle>();
+        auto captured = r.get<uint32_t>();
+        if (api_.get_sampler_index && api_.get_sampler_index(samplers_[h]) != captured) ++mismatches_;
+        break;
+    }
+    case Op::CreateShaderModule: {
+        ShaderModuleDesc desc{};
+        desc.stage = r.get<ShaderStage>();
+        desc.format = r.get<uint32_t>();
+        desc.data = r.blob(size);
+        desc.size = static_cast<uint32_t>(size);
+        auto captured = r.get<ShaderModuleHandle>();
+        ShaderModuleHandle h = api_.create_shader_module ? api_.create_shader_module(&desc) : 0;
+        if (!h && captured) ++mismatches_;
+        shaders_.create(captured, h, tracking_);
+        break;
+    }
+    case Op::DestroyShaderModule:
+        call(api_.destroy_shader_module, shaders_.take(r.get<ShaderModuleHandle>()));
+        break;
+    case Op::CreateVertexLayout: {
+        VertexLayoutDesc desc{};
+        desc.stride = r.get<uint32_t>();
+        const uint8_t* attrs = r.blob(size);
+        // Payload bytes are not necessarily aligned for VertexAttributeDesc
+        scratch_.assign(attrs, attrs + size);
+        desc.attributes = reinterpret_cast<const VertexAttributeDesc*>(scratch_.data());
+        desc.attribute_count = static_cast<uint32_t>(size / sizeof(VertexAttributeDesc));
+        auto captured = r.get<VertexLayoutHandle>();
+        VertexLayoutHandle h = api_.create_vertex_layout ? api_.create_vertex_layout(&desc) : 0;
+        if (!h && captured) ++mismatches_;
+        layouts_.create(captured, h, tracking_);
+        break;
+    }
+    case Op::DestroyVertexLayout:
+        call(api_.destroy_vertex_layout, layouts_.take(r.get<VertexLayoutHandle>()));
+        break;
+    case Op::CreatePipeline: {
+        auto desc = r.get<GraphicsPipelineDesc>();
+        desc.vs = shaders_[desc.vs];
+        desc.fs = shaders_[desc.fs];
+        desc.vertex_layout = layouts_[desc.vertex_layout];
+        auto captured = r.get<PipelineHandle>();
+        PipelineHandle h = api_.create_graphics_pipeline ? api_.create_graphics_pipeline(&desc) : 0;
+        if (!h && captured) ++mismatches_;
+        pipelines_.create(captured, h, tracking_);
+        break;
+    }
+    case Op::DestroyPipeline:
+        call(api_.destroy_pipeline, pipelines_.take(r.get<PipelineHandle>()));
+        break;
+    case Op::BeginCommands: {
+        auto captured = r.get<CommandListHandle>();
+        commands_.set(captured, api_.begin_commands ? api_.begin_commands() : 0);
+        break;
+    }
+    case Op::BeginPass: {
+        auto cmd = r.get<CommandListHandle>();
+        auto load = r.get<LoadOp>();
+        const uint8_t* colors = r.blob(size);
+        colors_.resize(size / sizeof(ColorAttachmentDesc));
+        if (size) std::memcpy(colors_.data(), colors, colors_.size() * sizeof(ColorAttachmentDesc));
+        for (auto& c : colors_) c.tex = textures_[c.tex];
+        DepthAttachmentDesc depth{};
+        bool hasDepth = r.get<bool>();
+        if (hasDepth) {
+            depth = r.get<DepthAttachmentDesc>();
+            depth.tex = textures_[depth.tex];
+        }
+        call(api_.cmd_begin_pass, commands_[cmd], load, colors_.data(), static_cast<uint32_t>(colors_.size()), hasDepth ? &depth : nullptr);
+        break;
+    }
+    case Op::EndPass:
+        call(api_.cmd_end_pass, commands_[r.get<CommandListHandle>()]);
+        break;
+    case Op::BindUniform: {
+        auto cmd = r.get<CommandListHandle>();
+        auto slot = r.get<uint32_t>();
+        auto h = r.get<BufferHandle>();
+        auto offset = r.get<uint64_t>();
+        call(api_.cmd_bind_uniform, commands_[cmd], slot, buffers_[h], offset);
+        break;
+    }
+    case Op::PushConstants: {
+        auto cmd = r.get<CommandListHandle>();
+        auto offset = r.get<uint32_t>();
+        const uint8_t* data = r.blob(size);
+        call(api_.cmd_push_constants, commands_[cmd], offset, static_cast<uint32_t>(size / 4), data);
+        break;
+    }
+    case Op::Barrier: {
+        auto cmd = r.get<CommandListHandle>();
+        auto h = r.get<BufferHandle>();
+        auto src = r.get<uint32_t>();
+        auto dst = r.get<uint32_t>();
+        call(api_.cmd_barrier, commands_[cmd], buffers_[h], src, dst);
+        break;
+    }
+    case Op::SetPipeline: {
+        auto cmd = r.get<CommandListHandle>();
+        auto h = r.get<PipelineHandle>();
+        call(api_.cmd_set_pipeline, commands_[cmd], pipelines_[h]);
+        break;
+    }
+    case Op::SetVertexBuffer: {
+        auto cmd = r.get<CommandListHandle>();
+        auto slot = r.get<uint32_t>();
+        auto h = r.get<BufferHandle>();
+        auto offset = r.get<uint64_t>();
+        call(api_.cmd_set_vertex_buffer, commands_[cmd], slot, buffers_[h], offset);
+        break;
+    }
+    case Op::SetIndexBuffer: {
+        auto cmd = r.get<CommandListHandle>();
+        auto h = r.get<BufferHandle>();
+        auto index32 = r.get<bool>();
+        auto offset = r.get<uint64_t>();
+        call(api_.cmd_set_index_buffer, commands_[cmd], buffers_[h], index32, offset);
+        break;
+    }
+    case Op::SetScissor: {
+        auto cmd = r.get<CommandListHandle>();
+        auto x = r.get<uint32_t>(), y = r.get<uint32_t>();
+        auto w = r.get<uint32_t>(), h = r.get<uint32_t>();
+        call(api_.cmd_set_scissor, commands_[cmd], x, y, w, h);
+        break;
+    }
+    case Op::Draw: {
+        auto cmd = r.get<CommandListHandle>();
+        auto vtx = r.get<uint32_t>(), inst = r.get<uint32_t>();
+        auto firstVtx = r.get<uint32_t>(), firstInst = r.get<uint32_t>();
+        call(api_.cmd_draw, commands_[cmd], vtx, inst, firstVtx, firstInst);
+        break;
+    }
+    case Op::DrawIndexed: {
+        auto cmd = r.get<CommandListHandle>();
+        auto idx = r.get<uint32_t>(), inst = r.get<uint32_t>(), firstIdx = r.get<uint32_t>();
+        auto vtxOffset = r.get<int32_t>();
+        auto firstInst = r.get<uint32_t>();
+        call(api_.cmd_draw_indexed, commands_[cmd], idx, inst, firstIdx, vtxOffset, firstInst);
+        break;
+    }
+    case Op::EndCommands:
+        call(api_.end_commands, commands_[r.get<CommandListHandle>()]);
+        break;
+    case Op::Submit: {
+        const uint8_t* lists = r.blob(size);
+        lists_.resize(size / sizeof(CommandListHandle));
+        if (size) std::memcpy(lists_.data(), lists, lists_.size() * sizeof(CommandListHandle));
+        for (auto& l : lists_) l = commands_[l];
+        call(api_.submit, lists_.data(), static_cast<uint32_t>(lists_.size()));
+        break;
+    }
+    case Op::Present:
+        call(api_.present, swapchains_[r.get<SwapchainHandle>()]);
+        break;
+    case Op::WaitIdle:
+        call(api_.wait_idle);
+        break;
+    default:
+        return false;
+    }
+    return !r.failed();
+}
+
+bool parse_args(int argc, char** argv, Options& opt) {
+    if (argc < 3) return false;
+    opt.capturePath = argv[1];
+    opt.pluginPath = argv[2];
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless") opt.headless = true;
+        else if (arg == "--warmup" && hasValue) opt.warmup = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--loops" && hasValue) opt.loops = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        else if (arg == "--csv" && hasValue) opt.csvPath = argv[++i];
+        else return false;
+    }
+    return true;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t i = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        std::cerr << "Usage: render_replay <capture.jrc> <plugin> [--headless] [--warmup N] [--loops N] [--csv out.csv]\n";
+        return 1;
+    }
+
+    // Load the whole capture up front so file IO stays out of the timings
+    std::ifstream in(opt.capturePath, std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    FileHeader header{};
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Failed to read " << opt.capturePath << "\n";
+        return 1;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion) {
+        std::cerr << opt.capturePath << " is not a version " << kVersion << " render capture\n";
+        return 1;
+    }
+
+    // Split into records; setup holds everything up to the first frame, frames are [BeginFrame, EndFrame]
+    std::vector<Record> records;
+    std::vector<size_t> frameStarts;
+    Extent2D swapSize{1280, 720};
+    for (size_t pos = sizeof(header); pos + sizeof(RecordHeader) <= file.size();) {
+        RecordHeader rh;
+        std::memcpy(&rh, file.data() + pos, sizeof(rh));
+        pos += sizeof(rh);
+        if (rh.op >= Op::Count || pos + rh.size > file.size()) {
+            std::cerr << "Truncated or corrupt capture at byte " << pos << ", replaying what was read\n";
+            break;
+        }
+        if (rh.op == Op::BeginFrame) frameStarts.push_back(records.size());
+        if (rh.op == Op::CreateSwapchain && rh.size >= sizeof(SwapchainDesc)) {
+            SwapchainDesc desc;
+            std::memcpy(&desc, file.data() + pos, sizeof(desc));
+            swapSize = desc.size;
+        }
+        records.push_back({rh.op, file.data() + pos, rh.size});
+        pos += rh.size;
+    }
+    if (frameStarts.empty()) {
+        std::cerr << "Capture contains no frames\n";
+        return 1;
+    }
+
+    RendererPlugin plugin;
+    if (!plugin.load(opt.pluginPath.c_str())) {
+        std::cerr << "Failed to load renderer plugin " << opt.pluginPath << "\n";
+        return 1;
+    }
+    RendererAPI& api = *plugin.api;
+
+    // Real backends need a surface for the captured swapchain; the null backend doesn't
+    std::unique_ptr<platform::IPlatform> host;
+    std::unique_ptr<platform::IWindow> window;
+    RendererDesc desc{static_cast<GfxBackend>(header.backend), nullptr, nullptr, nullptr, 3};
+    if (!opt.headless) {
+        host = platform::create_platform();
+        auto windowResult = host->create_window({"render_replay", swapSize.width, swapSize.height});
+        if (windowResult.hasError()) return 1;
+        window = std::move(windowResult).logError().value();
+        desc.platform_window = window->get_native_handle();
+        desc.platform_display = host->get_native_display_handle();
+    }
+    if (!api.init || !api.init(&desc)) {
+        std::cerr << "Renderer init failed\n";
+        return 1;
+    }
+
+    Replayer replayer(api);
+    bool malformed = false;
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && !malformed; ++i) {
+            if (!replayer.execute(records[i])) {
+                std::cerr << "Malformed record " << i << "\n";
+                malformed = true;
+            }
+        }
+    };
+
+    run(0, frameStarts.front());
+    replayer.setTracking(true);
+
+    std::vector<double> frameMs;
+    frameMs.reserve(frameStarts.size() * opt.loops);
+    for (uint32_t loop = 0; loop < opt.loops && !malformed; ++loop) {
+        for (size_t f = 0; f < frameStarts.size() && !malformed; ++f) {
+            // Each frame runs up to the next BeginFrame; trailing teardown records belong to the last one
+            // and are only replayed on the final loop
+            size_t begin = frameStarts[f];
+            size_t end = f + 1 < frameStarts.size() ? frameStarts[f + 1] : records.size();
+            if (f + 1 == frameStarts.size() && loop + 1 < opt.loops) {
+                while (end > begin && records[end - 1].op != Op::EndFrame) --end;
+            }
+            if (host) host->poll_events();
+
+            auto start = Clock::now();
+            run(begin, end);
+            frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+
+        // The next pass creates them again
+        if (loop + 1 < opt.loops) {
+            call(api.wait_idle);
+            replayer.releaseTracked();
+        }
+    }
+
+    call(api.wait_idle);
+    call(api.shutdown);
+    if (window) window->destroy();
+
+    std::vector<double> measured(frameMs.begin() + std::min<size_t>(opt.warmup, frameMs.size()), frameMs.end());
+    if (!opt.csvPath.empty()) {
+        std::ofstream csv(opt.csvPath);
+        csv << "frame,cpu_ms\n";
+        for (size_t i = 0; i < frameMs.size(); ++i) csv << i << "," << frameMs[i] << "\n";
+    }
+
+    std::sort(measured.begin(), measured.end());
+    double total = 0.0;
+    for (double ms : measured) total += ms;
+    std::cout << "Replayed " << frameMs.size() << " frames (" << records.size() << " records, "
+              << replayer.mismatches() << " mismatches)\n";
+    if (!measured.empty()) {
+        std::cout << "CPU submit ms over " << measured.size() << " frames:"
+                  << " min " << measured.front()
+                  << " avg " << total / static_cast<double>(measured.size())
+                  << " p50 " << percentile(measured, 0.50)
+                  << " p95 " << percentile(measured, 0.95)
+                  << " max " << measured.back() << "\n";
+    }
+    return malformed ? 1 : 0;
+}